@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include <CLI/CLI.hpp>
+#include <SDL3/SDL.h>
+
+#include "json.hpp"
+
+#include "Crobots++/Log.hpp"
+#include "Bench.hpp"
+#include "src/CpuBudget.hpp"
+#include "src/ModuleRegistry.hpp"
+#include "test/CountingAllocator.hpp"
+
+namespace Crobots
+{
+
+BenchTimer::BenchTimer()
+: m_startNs{0}
+, m_startAllocations{0}
+, m_ns{0}
+, m_allocations{0}
+, m_running{false}
+{}
+
+void BenchTimer::Start()
+{
+    if (!m_running)
+    {
+        m_running = true;
+        m_startAllocations = Test::GetAllocationCount();
+        m_startNs = SteadyNanoseconds();
+    }
+}
+
+void BenchTimer::Stop()
+{
+    if (m_running)
+    {
+        m_ns += SteadyNanoseconds() - m_startNs;
+        m_allocations += Test::GetAllocationCount() - m_startAllocations;
+        m_running = false;
+    }
+}
+
+uint64_t BenchTimer::GetNanoseconds() const
+{
+    return m_ns;
+}
+
+uint64_t BenchTimer::GetAllocations() const
+{
+    return m_allocations;
+}
+
+void BenchTimer::SetCounter(const std::string& name, double value)
+{
+    m_counters[name] = value;
+}
+
+const std::map<std::string, double>& BenchTimer::GetCounters() const
+{
+    return m_counters;
+}
+
+void BenchTimer::Skip(const std::string& reason)
+{
+    m_skipReason = reason;
+}
+
+const std::string& BenchTimer::GetSkipReason() const
+{
+    return m_skipReason;
+}
+
+BenchRunner::BenchRunner(const std::string& filter, uint64_t minNs)
+: m_filter{filter}
+, m_minNs{minNs}
+{}
+
+void BenchRunner::Add(const std::string& name, BenchFunc func)
+{
+    m_benchmarks.emplace_back(name, std::move(func));
+}
+
+std::vector<std::string> BenchRunner::GetNames() const
+{
+    std::vector<std::string> names;
+    for (const auto& [name, func] : m_benchmarks)
+    {
+        names.push_back(name);
+    }
+    return names;
+}
+
+const std::vector<BenchResult>& BenchRunner::Run()
+{
+    for (const auto& [name, func] : m_benchmarks)
+    {
+        if (name.find(m_filter) == std::string::npos)
+        {
+            continue;
+        }
+        uint64_t iterations = 1;
+        for (;;)
+        {
+            BenchTimer timer;
+            func(iterations, timer);
+            timer.Stop();
+            if (!timer.GetSkipReason().empty())
+            {
+                std::cout << std::format("{:<28} skipped: {}", name, timer.GetSkipReason()) << std::endl;
+                break;
+            }
+            uint64_t ns = std::max<uint64_t>(timer.GetNanoseconds(), 1);
+            if (ns < m_minNs)
+            {
+                // Aim a little past the minimum, but grow at most 100 times per run.
+                double scale = std::min(1.4 * m_minNs / ns, 100.0);
+                iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * scale));
+                continue;
+            }
+            BenchResult result{name, iterations, static_cast<double>(ns) / iterations,
+                               static_cast<double>(timer.GetAllocations()) / iterations, timer.GetCounters()};
+            std::string line = std::format("{:<28} {:>10} ops {:>14.1f} ns/op {:>10.2f} allocs/op",
+                                           name, result.ops, result.nsPerOp, result.allocationsPerOp);
+            for (const auto& [counter, value] : result.counters)
+            {
+                line += std::format("  {}={:.1f}", counter, value);
+            }
+            std::cout << line << std::endl;
+            m_results.push_back(std::move(result));
+            break;
+        }
+    }
+    return m_results;
+}
+
+}
+
+namespace
+{
+
+nlohmann::json ResultsJson(const std::vector<Crobots::BenchResult>& results, uint64_t seed)
+{
+    nlohmann::json json;
+    json["seed"] = seed;
+#ifdef NDEBUG
+    json["assertions"] = false;
+#else
+    json["assertions"] = true;
+#endif
+    json["benchmarks"] = nlohmann::json::array();
+    for (const Crobots::BenchResult& result : results)
+    {
+        nlohmann::json entry;
+        entry["name"] = result.name;
+        entry["ops"] = result.ops;
+        entry["ns_per_op"] = result.nsPerOp;
+        entry["allocs_per_op"] = result.allocationsPerOp;
+        entry["counters"] = result.counters;
+        json["benchmarks"].push_back(std::move(entry));
+    }
+    return json;
+}
+
+// Print each result's time against the same benchmark in an earlier results file.
+bool Compare(const std::vector<Crobots::BenchResult>& results, const std::string& path)
+{
+    std::ifstream file(path);
+    nlohmann::json baseline = nlohmann::json::parse(file, nullptr, false);
+    if (baseline.is_discarded() || !baseline.contains("benchmarks"))
+    {
+        std::cerr << "Cannot read benchmark results from " << path << std::endl;
+        return false;
+    }
+    std::cout << std::endl << "against " << path << ":" << std::endl;
+    for (const Crobots::BenchResult& result : results)
+    {
+        for (const nlohmann::json& entry : baseline["benchmarks"])
+        {
+            if (entry.value("name", "") != result.name)
+            {
+                continue;
+            }
+            double before = entry.value("ns_per_op", 0.0);
+            double allocationsBefore = entry.value("allocs_per_op", 0.0);
+            std::cout << std::format("{:<28} {:>14.1f} -> {:>14.1f} ns/op ({:+.1f}%) {:>10.2f} -> {:>10.2f} allocs/op",
+                                     result.name, before, result.nsPerOp,
+                                     before > 0 ? (result.nsPerOp / before - 1) * 100 : 0.0,
+                                     allocationsBefore, result.allocationsPerOp) << std::endl;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string jsonOut;
+    std::string compare;
+    std::string logLevels = "warn";
+    uint64_t minTimeMs = 200;
+    uint64_t seed = 1;
+    bool list = false;
+    // The robot modules are built next to the benchmarks.
+    std::string robotDir = std::filesystem::absolute(argv[0]).parent_path().string();
+
+    CLI::App parser("Crobots++ engine benchmarks", "crobots_bench");
+    parser.add_option("-f,--filter", filter, "Only run benchmarks whose name contains this");
+    parser.add_option("--json", jsonOut, "Write the results as JSON to this file");
+    parser.add_option("--compare", compare, "Compare against results written earlier with --json");
+    parser.add_option("--min-time-ms", minTimeMs, "Time each benchmark runs for at least (default 200)")->check(CLI::Number);
+    parser.add_option("-s,--seed", seed, "Random seed for every benchmark (default 1)")->check(CLI::Number);
+    parser.add_option("--robot-dir", robotDir, "Directory the robot modules are loaded from (default next to crobots_bench)");
+    parser.add_option("--log", logLevels, "Log levels, eg. engine=debug,scan=off (default warn)");
+    parser.add_flag("--list", list, "List the benchmarks and exit");
+    try
+    {
+        parser.parse(argc, argv);
+    }
+    catch (const CLI::ParseError& e)
+    {
+        return parser.exit(e);
+    }
+    if (!Crobots::Internal::SetLogLevels(logLevels))
+    {
+        std::cerr << "--log: invalid log levels: " << logLevels << std::endl;
+        return 1;
+    }
+    SDL_SetLogPriorities(SDL_LOG_PRIORITY_VERBOSE);
+    Crobots::ModuleRegistry::Get().SetDirectory(robotDir);
+
+    Crobots::BenchRunner runner(filter, minTimeMs * 1000000);
+    Crobots::AddEngineBenchmarks(runner, seed);
+    if (list)
+    {
+        for (const std::string& name : runner.GetNames())
+        {
+            std::cout << name << std::endl;
+        }
+        return 0;
+    }
+    const std::vector<Crobots::BenchResult>& results = runner.Run();
+    if (!jsonOut.empty())
+    {
+        std::ofstream file(jsonOut);
+        file << ResultsJson(results, seed).dump(2) << std::endl;
+        if (!file)
+        {
+            std::cerr << "Cannot write " << jsonOut << std::endl;
+            return 1;
+        }
+    }
+    if (!compare.empty() && !Compare(results, compare))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Crobots
+{
+
+// Keeps the compiler from optimizing away a result nobody reads.
+template<typename T>
+void KeepResult(T value)
+{
+    static volatile T sink;
+    sink = value;
+}
+
+// Times the parts of a benchmark between Start and Stop, and counts what they allocated.
+// Setup and teardown stay outside, so a benchmark can pause around them.
+class BenchTimer
+{
+public:
+    BenchTimer();
+
+    void Start();
+    void Stop();
+    uint64_t GetNanoseconds() const;
+    uint64_t GetAllocations() const;
+    // Extra figures for the result, reported next to ns/op, e.g. a phase's share of it.
+    void SetCounter(const std::string& name, double value);
+    const std::map<std::string, double>& GetCounters() const;
+    // The benchmark cannot run, and why.
+    void Skip(const std::string& reason);
+    const std::string& GetSkipReason() const;
+
+private:
+    uint64_t m_startNs;
+    uint64_t m_startAllocations;
+    uint64_t m_ns;
+    uint64_t m_allocations;
+    bool m_running;
+    std::map<std::string, double> m_counters;
+    std::string m_skipReason;
+};
+
+struct BenchResult
+{
+    std::string name;
+    uint64_t ops;
+    double nsPerOp;
+    double allocationsPerOp;
+    std::map<std::string, double> counters;
+};
+
+// Runs iterations ops of whatever it measures, starting and stopping the timer around them.
+using BenchFunc = std::function<void(uint64_t iterations, BenchTimer& timer)>;
+
+/*
+    Runs each benchmark with more and more iterations until one run takes at least the
+    minimum time, and keeps that run's result. Benchmarks run in the order they were added.
+*/
+class BenchRunner
+{
+public:
+    BenchRunner(const std::string& filter, uint64_t minNs);
+
+    void Add(const std::string& name, BenchFunc func);
+    std::vector<std::string> GetNames() const;
+    // Run every benchmark whose name contains the filter, printing each result as it comes.
+    const std::vector<BenchResult>& Run();
+
+private:
+    std::string m_filter;
+    uint64_t m_minNs;
+    std::vector<std::pair<std::string, BenchFunc>> m_benchmarks;
+    std::vector<BenchResult> m_results;
+};
+
+// The engine benchmarks. Robot modules are looked up in the module registry's directory.
+void AddEngineBenchmarks(BenchRunner& runner, uint64_t seed);
+
+}
@@ -0,0 +1,267 @@
+#include <format>
+#include <memory>
+#include <vector>
+
+#include "Crobots++/IRobot.hpp"
+#include "Crobots++/Random.hpp"
+#include "Bench.hpp"
+#include "src/Arena.hpp"
+#include "src/Engine.hpp"
+#include "src/ModuleRegistry.hpp"
+#include "src/Profiler.hpp"
+#include "src/ShotPool.hpp"
+#include "test/TestRobots.hpp"
+
+namespace Crobots
+{
+
+namespace
+{
+
+// Room for ten thousand robots without them spending the match in a pile.
+constexpr uint32_t ArenaSize = 1000;
+// The headless default, which the stock robots are written for.
+constexpr uint32_t MatchArenaSize = 100;
+// Stop a match that nobody wins.
+constexpr uint64_t MatchTicks = 20000;
+// Scans between ticks, which hand the scans' contacts over and clear them.
+constexpr uint64_t ScansPerTick = 256;
+
+// Sweeps its scanner round, fires at whatever it finds and drives somewhere new now and then.
+class Wanderer : public IRobot
+{
+public:
+    std::string_view GetName() const override { return "Wanderer"; }
+    void Tick() override
+    {
+        m_dir = Mod360(m_dir + 13);
+        float range = Scan(m_dir, 10);
+        if (range > 0)
+        {
+            Cannon(m_dir, range);
+        }
+        if (Rand(20) == 1)
+        {
+            Drive(Rand(360), 50);
+        }
+    }
+
+private:
+    float m_dir = 0;
+};
+
+void AddScanBenchmark(BenchRunner& runner, uint32_t count, uint64_t seed)
+{
+    runner.Add(std::format("scan/{}", count), [count, seed](uint64_t iterations, BenchTimer& timer)
+    {
+        std::shared_ptr<Engine> engine = Test::MakeEngine<Test::Idle>(count, ArenaSize, seed);
+        float dir = 0;
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            if (i % ScansPerTick == 0)
+            {
+                timer.Stop();
+                engine->Tick();
+                timer.Start();
+            }
+            KeepResult(engine->ScanResult(0, dir, 10));
+            dir = dir >= 353 ? 0 : dir + 7;
+        }
+        timer.Stop();
+    });
+}
+
+void AddTickBenchmark(BenchRunner& runner, uint32_t count, uint64_t seed)
+{
+    runner.Add(std::format("tick/{}", count), [count, seed](uint64_t iterations, BenchTimer& timer)
+    {
+        std::shared_ptr<Engine> engine = Test::MakeEngine<Wanderer>(count, ArenaSize, seed);
+        timer.Start();
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            if (engine->IsGameOver())
+            {
+                timer.Stop();
+                engine = Test::MakeEngine<Wanderer>(count, ArenaSize, seed);
+                timer.Start();
+            }
+            engine->Tick();
+        }
+        timer.Stop();
+    });
+}
+
+// The same ticks as tick/N, split into the engine's phases by the profiler. Each phase's
+// mean is a counter, which is where the robot sweeps (accel_robots, move_robots) and the
+// shot sweep (move_shots) are measured: they are private to the engine and only make
+// sense on its state.
+void AddPhaseBenchmark(BenchRunner& runner, uint32_t count, uint64_t seed)
+{
+    runner.Add(std::format("phases/{}", count), [count, seed](uint64_t iterations, BenchTimer& timer)
+    {
+        Profiler profiler;
+        std::shared_ptr<Engine> engine = Test::MakeEngine<Wanderer>(count, ArenaSize, seed);
+        engine->SetProfiler(&profiler);
+        timer.Start();
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            if (engine->IsGameOver())
+            {
+                timer.Stop();
+                engine = Test::MakeEngine<Wanderer>(count, ArenaSize, seed);
+                engine->SetProfiler(&profiler);
+                timer.Start();
+            }
+            engine->Tick();
+        }
+        timer.Stop();
+        double nsPerCycle = profiler.GetNanosecondsPerCycle();
+        for (uint32_t phase = 0; phase < static_cast<uint32_t>(Phase::Tick); phase++)
+        {
+            const CostHistogram& histogram = profiler.GetPhase(static_cast<Phase>(phase));
+            double mean = histogram.GetCount() > 0 ? static_cast<double>(histogram.GetTotal()) / histogram.GetCount() : 0;
+            timer.SetCounter(GetPhaseName(static_cast<Phase>(phase)), mean * nsPerCycle);
+        }
+    });
+}
+
+// What the engine's MoveShotsInFlight does every tick.
+void AddShotBenchmark(BenchRunner& runner, uint32_t count, uint64_t seed)
+{
+    runner.Add(std::format("shots/{}", count), [count, seed](uint64_t iterations, BenchTimer& timer)
+    {
+        Random random(seed, 0);
+        ShotPool shots;
+        shots.Reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            // Far enough that none of them land while the benchmark runs.
+            shots.Add(random.Bounded(ArenaSize), random.Bounded(ArenaSize), random.Bounded(360), 1, 1e9f);
+        }
+        timer.Start();
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            shots.Integrate();
+        }
+        timer.Stop();
+        KeepResult(shots.m_currentX[0]);
+        timer.SetCounter("ns_per_shot", static_cast<double>(timer.GetNanoseconds()) / iterations / count);
+    });
+}
+
+void AddPositionAheadBenchmark(BenchRunner& runner, uint64_t seed)
+{
+    runner.Add("position_ahead", [seed](uint64_t iterations, BenchTimer& timer)
+    {
+        // Facings from -720 to 720 degrees, so the normalization loops have work to do.
+        Random random(seed, 0);
+        std::vector<float> facings(1024);
+        for (float& facing : facings)
+        {
+            facing = static_cast<float>(random.Bounded(1440)) - 720.0f;
+        }
+        timer.Start();
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            Position position = Engine::GetPositionAhead(50, 50, facings[i % facings.size()], 10);
+            KeepResult(position.GetX());
+        }
+        timer.Stop();
+    });
+}
+
+// A whole headless match between two robot modules, loading included.
+void AddMatchBenchmark(BenchRunner& runner, const std::string& first, const std::string& second, uint64_t seed)
+{
+    runner.Add(std::format("match/{}_vs_{}", first, second), [first, second, seed](uint64_t iterations, BenchTimer& timer)
+    {
+        // Holding the factories keeps the modules open between matches.
+        RobotFactory factories[] = {ModuleRegistry::Get().Find(first), ModuleRegistry::Get().Find(second)};
+        if (!factories[0] || !factories[1])
+        {
+            timer.Skip(std::format("cannot load {} and {}", first, second));
+            return;
+        }
+        uint64_t ticks = 0;
+        timer.Start();
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            auto engine = std::make_shared<Engine>();
+            engine->Init(Arena(MatchArenaSize, MatchArenaSize), false, true, false, seed);
+            std::vector<std::shared_ptr<IRobot>> robots;
+            for (uint32_t id = 0; id < 2; id++)
+            {
+                robots.emplace_back(factories[id].create(engine->GetProxy(id)));
+            }
+            engine->Load(std::move(robots));
+            while (!engine->IsGameOver() && engine->GetTick() < MatchTicks)
+            {
+                engine->Tick();
+            }
+            ticks += engine->GetTick();
+            engine->Unload();
+        }
+        timer.Stop();
+        timer.SetCounter("ticks", static_cast<double>(ticks) / iterations);
+    });
+}
+
+}
+
+// The same match again and again on one engine, made ready with Reset rather than rebuilt.
+void AddRematchBenchmark(BenchRunner& runner, const std::string& first, const std::string& second, uint64_t seed)
+{
+    runner.Add(std::format("rematch/{}_vs_{}", first, second), [first, second, seed](uint64_t iterations, BenchTimer& timer)
+    {
+        RobotFactory factories[] = {ModuleRegistry::Get().Find(first), ModuleRegistry::Get().Find(second)};
+        if (!factories[0] || !factories[1])
+        {
+            timer.Skip(std::format("cannot load {} and {}", first, second));
+            return;
+        }
+        auto engine = std::make_shared<Engine>();
+        engine->Init(Arena(MatchArenaSize, MatchArenaSize), false, true, false, seed);
+        std::vector<std::shared_ptr<IRobot>> robots;
+        for (uint32_t id = 0; id < 2; id++)
+        {
+            robots.emplace_back(factories[id].create(engine->GetProxy(id)));
+        }
+        engine->Load(std::move(robots));
+        // The first match grows the engine's buffers; the timed ones reuse them.
+        uint64_t ticks = engine->RunMatch(MatchTicks).ticks;
+        timer.Start();
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            engine->Reset(seed);
+            ticks += engine->RunMatch(MatchTicks).ticks;
+        }
+        timer.Stop();
+        engine->Unload();
+        timer.SetCounter("ticks", static_cast<double>(ticks) / (iterations + 1));
+    });
+}
+
+void AddEngineBenchmarks(BenchRunner& runner, uint64_t seed)
+{
+    for (uint32_t count : {2, 10, 100, 1000, 10000})
+    {
+        AddScanBenchmark(runner, count, seed);
+    }
+    for (uint32_t count : {2, 10, 100, 1000, 10000})
+    {
+        AddTickBenchmark(runner, count, seed);
+    }
+    for (uint32_t count : {10, 1000})
+    {
+        AddPhaseBenchmark(runner, count, seed);
+    }
+    for (uint32_t count : {10, 100, 1000, 10000, 100000})
+    {
+        AddShotBenchmark(runner, count, seed);
+    }
+    AddPositionAheadBenchmark(runner, seed);
+    AddMatchBenchmark(runner, "Doofus", "Dummy", seed);
+    AddRematchBenchmark(runner, "Doofus", "Dummy", seed);
+}
+
+}
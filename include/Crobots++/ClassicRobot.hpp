@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "Crobots++/IRobot.hpp"
+
+namespace Crobots
+{
+
+class Coroutine;
+
+/*
+    A robot written the way classic Crobots robots were: Run() is the robot's main(), and
+    typically loops forever.
+
+        void Run() override
+        {
+            for (;;)
+            {
+                float range = Scan(m_dir, 10);
+                ...
+                Drive(m_dir, 50);
+            }
+        }
+
+    Run() executes on a small stack of its own. Every tick the engine resumes it, and it
+    runs until it has used up the tick's allowance: CallsPerTick calls to the methods
+    below, and one call each to Scan(), Cannon() and Drive(). The call past the allowance
+    waits for the next tick, so a loop that keeps calling the API cannot hog the engine.
+    Scan() waits for the scanner to rest as well. When Run() returns the robot sits still
+    for the rest of the match.
+*/
+class ClassicRobot : public IRobot
+{
+public:
+    static constexpr uint32_t CallsPerTick = 32;
+
+    ~ClassicRobot() override;
+    void Tick() final;
+
+protected:
+    ClassicRobot();
+
+    virtual void Run() = 0;
+
+    // Give up the rest of this tick.
+    void NextTick();
+
+    float Scan(float degree, float resolution);
+    bool Cannon(float degree, float range);
+    void Drive(float degree, float speed);
+    uint32_t Damage();
+    float Speed();
+    float LocX();
+    float LocY();
+    float Facing();
+
+private:
+    // Count an API call against the allowance, waiting for the next tick if it is spent.
+    void Spend();
+
+    std::unique_ptr<Coroutine> m_coroutine;
+    uint32_t m_calls;
+    bool m_scanned;
+    bool m_fired;
+    bool m_drove;
+};
+
+}
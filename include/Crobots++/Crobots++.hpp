@@ -14,5 +14,18 @@
         return IRobot::Create<name>(proxy); \
     }
 
+// Export several robot classes from one module, e.g. CROBOTS_GETROBOTS(Rook, Bishop). They
+// are loaded as Module:Rook and Module:Bishop; the module name alone means the first.
+#define CROBOTS_GETROBOTS(...) \
+    CROBOTS_ENTRYPOINT const char* GetRobotNames() \
+    { \
+        return #__VA_ARGS__; \
+    } \
+    CROBOTS_ENTRYPOINT const ::Crobots::GetRobotFunc* GetRobotFactories() \
+    { \
+        return ::Crobots::RobotFactories<__VA_ARGS__>::table; \
+    }
+
+#include <Crobots++/ClassicRobot.hpp>
 #include <Crobots++/IRobot.hpp>
 #include <Crobots++/Log.hpp>
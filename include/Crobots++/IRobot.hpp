@@ -1,19 +1,25 @@
 #pragma once
 
 #include <cstdint>
+#include <format>
 #include <iostream>
+#include <new>
 #include <random>
+#include <span>
+#include <string>
 #include <string_view>
 #include <sstream>
 #include <vector>
 
 #include "Crobots++/Log.hpp"
+#include "Crobots++/Random.hpp"
 
 namespace Crobots
 {
 
 // Forward declaration
 class InternalRobotProxy;
+class RobotStates;
 
 enum class DamageType
 {
@@ -21,6 +27,10 @@ enum class DamageType
     Cannon,
     HitRobot,
     HitWall,
+    // Went over its CPU budget.
+    Disqualified,
+    // Its sandbox crashed or missed the tick deadline.
+    Crashed,
 }; 
 
 struct CollisionDeathData
@@ -55,25 +65,14 @@ enum class CannonType
     Standard
 };
 
-class ContactDetails
+// A robot found by a scan: where the scan came from, where the robot was, and the scan's
+// bearing and the range to it. Plain data, kept by value.
+struct ContactDetails
 {
-public:
-    ContactDetails(float fromx, float fromy, float tox, float toy, float bearing, float range)
-    : m_fromx{fromx}
-    , m_fromy{fromy}
-    , m_tox{tox}
-    , m_toy{toy}
-    , m_bearing{bearing}
-    , m_range{range}
-    {}
-
-    std::string ToString()
+    std::string ToString() const
     {
-        std::stringstream ss;
-        ss << "ContactDetails: " << m_fromx << " " << m_fromy << " -> "
-           << m_tox << " " << m_toy << " "
-           << m_bearing << " " << m_range << std::endl;
-        return ss.str();
+        return std::format("ContactDetails: {} {} -> {} {} {} {}\n",
+                           m_fromx, m_fromy, m_tox, m_toy, m_bearing, m_range);
     }
 
     float m_fromx;
@@ -98,8 +97,8 @@ public:
     // Tick is where the robot does all of its work. It is the replacement for the main loop
     // in the original game. To avoid abuse of the api in this call, most functions called
     // have a limit allowable of once per tick, like drive, cannon, scan, etc.
-    // It has not yet been decided whether to run the robots in their own threads, or give
-    // them a time limit, as such implementations can be error prone.
+    // Robots may be ticked on several threads at once, and the engine times every call; a
+    // match can set a CPU budget per tick and per match (see CpuBudget in the engine).
     virtual void Tick() = 0;
     uint32_t GetId() const;
     void SetId(uint32_t id);
@@ -108,6 +107,8 @@ public:
     float GetFacing() const;
     float GetScanDir() const;
     float GetResolution() const;
+    float GetDamage() const;
+    // True if another robot's scan found this one during the last tick.
     bool IsDetected() const;
 
     struct DeathData GetDeathData() const;
@@ -120,47 +121,28 @@ public:
     {
         IRobot* robot = new T();
         robot->m_proxy = proxy;
+        robot->m_create = &Create<T>;
+        robot->m_recreate = &Recreate<T>;
         return robot;
     }
-    void AddContact(std::unique_ptr<ContactDetails>& contact);
-    const std::vector<std::unique_ptr<ContactDetails>>& GetContacts();
+    void AddContact(const ContactDetails& contact);
+    // This tick's scan contacts, valid until the robot's next tick.
+    std::span<const ContactDetails> GetContacts() const;
     void ClearContacts();
 
 
 private:
-    // Current X and Y location. Floats for more accurate resolution, but the LocX and LocY
-    // methods return integers, rounded off.
-    float m_currentX;
-    float m_currentY;
-    // Post-move X and Y location.
-    float m_nextX;
-    float m_nextY;
-    // Speed we are trying to achieve.
-    float m_desiredSpeed;
-    // Current speed
-    float m_speed;
+    // Position, speed, facing, damage and the reload and scan deadlines live in the
+    // engine's RobotStates arrays; this robot's slot is m_index.
+    RobotStates* m_states;
+    uint32_t m_index;
 
     float m_scan_dir;
     float m_resolution;
 
-    // Facing we would like to have.
-    float m_desiredFacing;
-    // Facing we currently have.
-    float m_facing;
-
     // default to 65535 for now, so effectively unlimited, planning for the future
     uint32_t m_rounds;
 
-    // Some performance parameters for the future.
-    float m_acceleration;
-    float m_braking;
-    float m_turnRate;
-
-    // How much we are hurt.
-    float m_damage;
-
-    // A scan counter, reset at the beginning of each Tick.
-    uint32_t m_scanCountDown;
     // The number of ticks that must pass between scans.
     uint32_t m_ticksPerScan;
 
@@ -170,9 +152,6 @@ private:
     float m_cannonShotRange;
     float m_cannonShotSpeed;
 
-    // Countdown until done reloading.
-    uint32_t m_cannonTimeUntilReload;
-
     // Cannon parameters.
     CannonType m_cannonType;
     uint32_t m_cannonReloadTime;
@@ -181,26 +160,52 @@ private:
     // Robot detected by another robot's scan?
     bool m_detected;
 
-    // Set robot to indestructible
-    bool m_indestructible;
-
     struct DeathData m_deathdata;
 
     void TickInit();
     bool RegisterShot(CannonType weapon, float degree, float range);
-    void AccelRobot();
-    void MoveRobot();
-    void HitTheWall();
-    bool IsDead();
+    bool IsDead() const;
     void Detected();
 
-    std::vector<std::unique_ptr<ContactDetails>> m_contacts;
+    // Cleared every tick but never shrunk, so once it has held a tick's contacts adding
+    // them again does not allocate.
+    std::vector<ContactDetails> m_contacts;
 
     InternalRobotProxy* m_proxy;
 
-    static uint32_t BoundedRand(uint32_t range);
-    static std::random_device rd;
-    static std::mt19937 gen;
+    // How the robot was made, so a sandbox can make it again in another process.
+    IRobot* (*m_create)(InternalRobotProxy* proxy);
+    // Destroys the robot and constructs it again in the same memory, for the next match,
+    // and returns the new robot: pointers to the old one must not be used to reach it.
+    // Set by Create, which knows the robot's type.
+    IRobot* (*m_recreate)(IRobot* robot);
+
+    // The new robot keeps its proxy and the contact buffer's capacity, so a robot made
+    // again allocates nothing unless its own constructor does. The old robot is gone
+    // before the new one is made, and its owner would destroy it again, so a constructor
+    // that throws here ends the program.
+    template<typename T>
+    static IRobot* Recreate(IRobot* robot)
+    {
+        InternalRobotProxy* proxy = robot->m_proxy;
+        std::vector<ContactDetails> contacts = std::move(robot->m_contacts);
+        T* storage = static_cast<T*>(robot);
+        storage->~T();
+        auto construct = [storage]() noexcept { new (storage) T(); };
+        construct();
+        IRobot* fresh = std::launder(storage);
+        fresh->m_proxy = proxy;
+        fresh->m_create = &Create<T>;
+        fresh->m_recreate = &Recreate<T>;
+        contacts.clear();
+        fresh->m_contacts = std::move(contacts);
+        return fresh;
+    }
+
+    // Each robot draws from its own stream of the engine's seed, keyed by its index, so
+    // its numbers do not depend on other robots, engines or threads.
+    uint32_t BoundedRand(uint32_t range);
+    Random m_random;
     static float GetActualSpeed(float speed);
 
 protected:
@@ -219,8 +224,7 @@ protected:
         360 operation, and made positive if necessary. Resolution controls the
         scanner's sensing resolution, up to +/- 5 degrees, so 10 degrees in total.
 
-        Scanning takes time, so a scan result can only be returned at a rate of m_ticksPerScan.
-        Each Scan call reduces a counter by 1 until it reaches 0 and a scan can be made.
+        Scanning takes time, so after a scan the scanner rests for m_ticksPerScan ticks.
         Scan returns -1 if a scan cannot be performed yet.
     */
     float Scan(float degree, float resolution);
@@ -235,6 +239,11 @@ protected:
     */
     bool Cannon(float degree, float range);
 
+    // Whether the scanner has rested and the cannon has reloaded, so that Scan() and
+    // Cannon() would go ahead this tick.
+    bool ScanReady() const;
+    bool CannonReady() const;
+
     /*
         The Drive() method activates the robot's drive mechanism, on a specified
         heading and speed. Degree is forced into the range 0-359 as in Scan(). Speed
@@ -291,4 +300,14 @@ protected:
     void SetDeathData(struct DeathData deathdata);
 };
 
+// Makes a robot with the given proxy; what robot modules export, see CROBOTS_GETROBOT.
+using GetRobotFunc = IRobot* (*)(InternalRobotProxy* proxy);
+
+// The factories of a module with several robot classes, see CROBOTS_GETROBOTS.
+template<typename... Robots>
+struct RobotFactories
+{
+    static constexpr GetRobotFunc table[] = { &IRobot::Create<Robots>... };
+};
+
 }
@@ -1,20 +1,24 @@
 #pragma once
 
-#include <numbers>
+#include <cstdint>
 
 namespace Crobots
 {
 
 class Engine;
 
+// A robot's handle on the engine. The engine owns one per robot slot, see
+// Engine::GetProxy, and hands it to the robot when it is created.
 class InternalRobotProxy
 {
 public:
-    InternalRobotProxy(uint32_t id, std::shared_ptr<Engine> engine);
+    InternalRobotProxy(uint32_t id, Engine* engine);
 
     float GetArenaX();
     float GetArenaY();
     float ScanResult(uint32_t id, float degree, float resolution);
+    // The tick the engine is running.
+    uint64_t GetTick() const;
     uint32_t GetId() const;
     void SetId(const uint32_t id);
 
@@ -22,8 +26,7 @@ private:
     // This id should be a simple integer uniquely identifying the robot based on the order
     // in which it was loaded.
     uint32_t m_id;
-    // FIXME: check for circular reference
-    std::shared_ptr<Engine> m_engine;
+    Engine* m_engine;
 };
 
 }
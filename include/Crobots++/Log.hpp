@@ -1,14 +1,272 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <format>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
-#define CROBOTS_LOG(fmt, ...) \
-    ::Crobots::Internal::Log(std::format("[{}:{}] " fmt, __FILE__, __LINE__ __VA_OPT__(,) __VA_ARGS__))
+#include "Crobots++/LogRecord.hpp"
+
+namespace Crobots
+{
+
+enum class LogLevel : uint8_t
+{
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off,
+};
+
+enum class LogCategory : uint8_t
+{
+    Engine,
+    Scan,
+    Shots,
+    Robot,
+    Loader,
+    Render,
+    Count,
+};
+
+}
+
+// Sites below the compile-time minimum level are discarded by the compiler, arguments and
+// all. The default keeps everything in debug builds and drops Trace and Debug in release
+// builds. Override for a whole build with -DCROBOTS_LOG_MIN_LEVEL=<0-5> (0 is Trace, 5 is
+// Off), or for one category with e.g. -DCROBOTS_LOG_MIN_LEVEL_SCAN=5.
+#ifndef CROBOTS_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define CROBOTS_LOG_MIN_LEVEL 2
+#else
+#define CROBOTS_LOG_MIN_LEVEL 0
+#endif
+#endif
+#ifndef CROBOTS_LOG_MIN_LEVEL_ENGINE
+#define CROBOTS_LOG_MIN_LEVEL_ENGINE CROBOTS_LOG_MIN_LEVEL
+#endif
+#ifndef CROBOTS_LOG_MIN_LEVEL_SCAN
+#define CROBOTS_LOG_MIN_LEVEL_SCAN CROBOTS_LOG_MIN_LEVEL
+#endif
+#ifndef CROBOTS_LOG_MIN_LEVEL_SHOTS
+#define CROBOTS_LOG_MIN_LEVEL_SHOTS CROBOTS_LOG_MIN_LEVEL
+#endif
+#ifndef CROBOTS_LOG_MIN_LEVEL_ROBOT
+#define CROBOTS_LOG_MIN_LEVEL_ROBOT CROBOTS_LOG_MIN_LEVEL
+#endif
+#ifndef CROBOTS_LOG_MIN_LEVEL_LOADER
+#define CROBOTS_LOG_MIN_LEVEL_LOADER CROBOTS_LOG_MIN_LEVEL
+#endif
+#ifndef CROBOTS_LOG_MIN_LEVEL_RENDER
+#define CROBOTS_LOG_MIN_LEVEL_RENDER CROBOTS_LOG_MIN_LEVEL
+#endif
+
+// A disabled site costs one load and a predictable branch. An enabled site either formats
+// the message, or, when a binary sink is installed, copies the raw arguments into an event
+// for the site, which is registered with its format string the first time it is reached.
+#define CROBOTS_LOG_AT(level, category, fmt, ...) \
+    do \
+    { \
+        if constexpr (::Crobots::Internal::IsCompiledIn(level, category)) \
+        { \
+            if (::Crobots::Internal::IsEnabled(level, category)) [[unlikely]] \
+            { \
+                if (::Crobots::Internal::LogSink* sink = ::Crobots::Internal::GetLogSink()) \
+                { \
+                    static const uint32_t site = sink->RegisterSite(level, category, __FILE__, __LINE__, fmt, \
+                        decltype(::Crobots::Internal::MakeLogArgList(__VA_ARGS__))::Types()); \
+                    ::Crobots::Internal::LogEvent(sink, site __VA_OPT__(,) __VA_ARGS__); \
+                } \
+                else \
+                { \
+                    ::Crobots::Internal::Log(level, category, \
+                        std::format("[{}:{}] " fmt, __FILE__, __LINE__ __VA_OPT__(,) __VA_ARGS__)); \
+                } \
+            } \
+        } \
+    } while (0)
+
+#define CROBOTS_LOG_TRACE(category, fmt, ...) \
+    CROBOTS_LOG_AT(::Crobots::LogLevel::Trace, ::Crobots::LogCategory::category, fmt __VA_OPT__(,) __VA_ARGS__)
+#define CROBOTS_LOG_DEBUG(category, fmt, ...) \
+    CROBOTS_LOG_AT(::Crobots::LogLevel::Debug, ::Crobots::LogCategory::category, fmt __VA_OPT__(,) __VA_ARGS__)
+#define CROBOTS_LOG_INFO(category, fmt, ...) \
+    CROBOTS_LOG_AT(::Crobots::LogLevel::Info, ::Crobots::LogCategory::category, fmt __VA_OPT__(,) __VA_ARGS__)
+#define CROBOTS_LOG_WARN(category, fmt, ...) \
+    CROBOTS_LOG_AT(::Crobots::LogLevel::Warn, ::Crobots::LogCategory::category, fmt __VA_OPT__(,) __VA_ARGS__)
+#define CROBOTS_LOG_ERROR(category, fmt, ...) \
+    CROBOTS_LOG_AT(::Crobots::LogLevel::Error, ::Crobots::LogCategory::category, fmt __VA_OPT__(,) __VA_ARGS__)
+
+// Logging for robots.
+#define CROBOTS_LOG(fmt, ...) CROBOTS_LOG_INFO(Robot, fmt __VA_OPT__(,) __VA_ARGS__)
 
 namespace Crobots::Internal
 {
 
-void Log(const std::string& string);
+inline constexpr uint8_t CompiledLevels[] = {
+    CROBOTS_LOG_MIN_LEVEL_ENGINE,
+    CROBOTS_LOG_MIN_LEVEL_SCAN,
+    CROBOTS_LOG_MIN_LEVEL_SHOTS,
+    CROBOTS_LOG_MIN_LEVEL_ROBOT,
+    CROBOTS_LOG_MIN_LEVEL_LOADER,
+    CROBOTS_LOG_MIN_LEVEL_RENDER,
+};
+static_assert(std::size(CompiledLevels) == static_cast<size_t>(LogCategory::Count));
+
+// Receives log sites and events in binary mode.
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+    // Returns the id that events from this site carry.
+    virtual uint32_t RegisterSite(LogLevel level, LogCategory category, std::string_view file, uint32_t line,
+                                  std::string_view format, std::string_view types) = 0;
+    virtual void WriteEvent(uint32_t site, const char* arguments, uint32_t size) = 0;
+};
+
+struct LogState
+{
+    std::atomic<uint8_t> levels[static_cast<size_t>(LogCategory::Count)];
+    std::atomic<LogSink*> sink;
+};
+
+// The executable and every robot module link their own copy of this library, so the
+// runtime levels live in one LogState that the first copy to start publishes and the
+// others pick up. Until that happens a copy uses its own defaults.
+LogState* ShareLogState();
+inline LogState g_localLogState{{
+    static_cast<uint8_t>(LogLevel::Info),
+    static_cast<uint8_t>(LogLevel::Info),
+    static_cast<uint8_t>(LogLevel::Info),
+    static_cast<uint8_t>(LogLevel::Info),
+    static_cast<uint8_t>(LogLevel::Info),
+    static_cast<uint8_t>(LogLevel::Info),
+}, nullptr};
+inline LogState* g_logState = &g_localLogState;
+inline const bool g_logStateShared = (g_logState = ShareLogState(), true);
+
+constexpr bool IsCompiledIn(LogLevel level, LogCategory category)
+{
+    return static_cast<uint8_t>(level) >= CompiledLevels[static_cast<size_t>(category)];
+}
+
+inline bool IsEnabled(LogLevel level, LogCategory category)
+{
+    return static_cast<uint8_t>(level) >=
+        g_logState->levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+}
+
+inline LogSink* GetLogSink()
+{
+    return g_logState->sink.load(std::memory_order_relaxed);
+}
+
+template<typename T>
+constexpr LogArgType GetLogArgType()
+{
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>)
+        return LogArgType::Bool;
+    else if constexpr (std::is_same_v<U, char>)
+        return LogArgType::Char;
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+        return LogArgType::Int;
+    else if constexpr (std::is_integral_v<U>)
+        return LogArgType::UInt;
+    else if constexpr (std::is_same_v<U, float>)
+        return LogArgType::Float;
+    else if constexpr (std::is_floating_point_v<U>)
+        return LogArgType::Double;
+    else
+        return LogArgType::String;
+}
+
+template<typename... Args>
+struct LogArgList
+{
+    static constexpr std::string_view Types()
+    {
+        return std::string_view(s_types, sizeof...(Args));
+    }
+    static constexpr char s_types[sizeof...(Args) + 1] = {static_cast<char>(GetLogArgType<Args>())..., '\0'};
+};
+
+// Only used in decltype, so the arguments are never evaluated twice.
+template<typename... Args>
+LogArgList<Args...> MakeLogArgList(const Args&...);
+
+// Arguments that do not fit are truncated; an event never exceeds this many bytes.
+inline constexpr uint32_t LogEventMax = 1024;
+
+template<typename T>
+void EncodeLogArg(char* buffer, uint32_t& size, const T& arg)
+{
+    constexpr LogArgType type = GetLogArgType<T>();
+    auto put = [&](const auto& value) {
+        if (size + sizeof(value) <= LogEventMax)
+        {
+            std::memcpy(buffer + size, &value, sizeof(value));
+        }
+        size = std::min<uint32_t>(size + sizeof(value), LogEventMax);
+    };
+    if constexpr (type == LogArgType::Bool)
+        put(static_cast<uint8_t>(arg));
+    else if constexpr (type == LogArgType::Char)
+        put(arg);
+    else if constexpr (type == LogArgType::Int)
+        put(static_cast<int64_t>(arg));
+    else if constexpr (type == LogArgType::UInt)
+        put(static_cast<uint64_t>(arg));
+    else if constexpr (type == LogArgType::Float)
+        put(arg);
+    else if constexpr (type == LogArgType::Double)
+        put(static_cast<double>(arg));
+    else
+    {
+        auto string = [&](std::string_view text) {
+            uint32_t room = size + sizeof(uint16_t) <= LogEventMax ? LogEventMax - size - sizeof(uint16_t) : 0;
+            uint16_t length = std::min<size_t>(text.size(), room);
+            put(length);
+            std::memcpy(buffer + size, text.data(), length);
+            size += length;
+        };
+        if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            string(arg);
+        else
+            string(std::format("{}", arg));
+    }
+}
+
+template<typename... Args>
+void LogEvent(LogSink* sink, uint32_t site, const Args&... args)
+{
+    if constexpr (sizeof...(Args) == 0)
+    {
+        sink->WriteEvent(site, nullptr, 0);
+    }
+    else
+    {
+        char buffer[LogEventMax];
+        uint32_t size = 0;
+        (EncodeLogArg(buffer, size, args), ...);
+        sink->WriteEvent(site, buffer, size);
+    }
+}
+
+void Log(LogLevel level, LogCategory category, const std::string& string);
+
+void SetLogLevel(LogCategory category, LogLevel level);
+// Switch CROBOTS_LOG to binary events, or back to text with nullptr. Set once at startup;
+// sites remember the sink's id for them.
+void SetLogSink(LogSink* sink);
+// Apply a comma separated list of category=level pairs, eg. "engine=debug,scan=off".
+// A bare level applies to every category. Returns false, changing nothing, on bad input.
+bool SetLogLevels(std::string_view spec);
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Layout of the binary log written with --log-binary and read by crobots_logdecode.
+// Integers are stored in host byte order; logs are decoded on the machine that wrote them.
+//
+// The file starts with LogMagic, followed by records that each start with a type byte:
+//   Site:  u32 id, u8 level, u8 category, u32 line, u16 length + file,
+//          u16 length + format, u8 count + argument types
+//   Event: u32 site, u64 nanoseconds, u16 length + arguments
+//   Text:  u8 SDL priority, u32 length + text, for lines that did not come from a site
+// A site record always precedes the events that refer to it.
+
+namespace Crobots::Internal
+{
+
+inline constexpr char LogMagic[8] = {'C', 'R', 'B', 'L', 'O', 'G', '1', '\0'};
+
+// Indexed by LogCategory.
+inline constexpr std::string_view LogCategoryNames[] = {
+    "engine",
+    "scan",
+    "shots",
+    "robot",
+    "loader",
+    "render",
+};
+
+enum class LogRecordType : uint8_t
+{
+    Site = 1,
+    Event = 2,
+    Text = 3,
+};
+
+// How each argument of an event is stored.
+enum class LogArgType : char
+{
+    Bool = 'b',   // u8
+    Char = 'c',   // char
+    Int = 'i',    // i64
+    UInt = 'u',   // u64
+    Float = 'f',  // float
+    Double = 'd', // double
+    String = 's', // u16 length + bytes; anything else is formatted to a string up front
+};
+
+}
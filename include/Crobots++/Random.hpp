@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Crobots
+{
+
+// Counter-based random numbers: the n-th value of a stream is a SplitMix64 hash of the
+// stream's key and n, so each stream depends only on (seed, stream id) and how many values
+// it has handed out, never on what any other stream or thread did. Results are the same
+// with every compiler and standard library.
+class Random
+{
+public:
+    constexpr Random(uint64_t seed = 0, uint64_t stream = 0)
+        : m_key{Mix(Mix(seed) ^ (stream * Gamma + Gamma))}
+        , m_counter{0}
+    {}
+
+    constexpr void Seed(uint64_t seed, uint64_t stream)
+    {
+        *this = Random(seed, stream);
+    }
+
+    constexpr uint64_t Next()
+    {
+        return Mix(m_key + ++m_counter * Gamma);
+    }
+
+    // Uniform in 1 - range, without modulo bias. A range of 0 gives 0.
+    constexpr uint32_t Bounded(uint32_t range)
+    {
+        if (range == 0)
+        {
+            return 0;
+        }
+        // Lemire's multiply-shift, rejecting the few values that would favour low results.
+        uint32_t threshold = -range % range;
+        for (;;)
+        {
+            uint64_t product = (Next() >> 32) * range;
+            if (static_cast<uint32_t>(product) >= threshold)
+            {
+                return static_cast<uint32_t>(product >> 32) + 1;
+            }
+        }
+    }
+
+    constexpr uint64_t GetCounter() const
+    {
+        return m_counter;
+    }
+
+private:
+    static constexpr uint64_t Gamma = 0x9E3779B97F4A7C15ull;
+
+    static constexpr uint64_t Mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t m_key;
+    uint64_t m_counter;
+};
+
+}
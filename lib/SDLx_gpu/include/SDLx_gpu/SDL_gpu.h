@@ -24,6 +24,14 @@ SDL_GPUTexture* SDLx_GPUCreateDepthTexture(SDL_GPUDevice* device, int width, int
 SDL_GPUSampler* SDLx_GPUCreateNearestSampler(SDL_GPUDevice* device);
 SDL_GPUSampler* SDLx_GPUCreateLinearSampler(SDL_GPUDevice* device);
 
+/*
+ * Tracing: func is called on entering (begin true) and leaving each step of
+ * SDLx_GPUSubmitRenderer, on the calling thread. name is a string literal.
+ */
+
+typedef void (*SDLx_GPUTraceFunc)(void* userdata, const char* name, bool begin);
+void SDLx_GPUSetTraceFunction(SDLx_GPUTraceFunc func, void* userdata);
+
 /*
  * Renderer
  */
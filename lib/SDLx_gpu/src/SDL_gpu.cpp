@@ -29,10 +29,36 @@
 
 static constexpr size_t NullTextId = std::numeric_limits<size_t>::max();
 
+static SDLx_GPUTraceFunc trace_func;
+static void* trace_userdata;
+
+struct TraceSpan
+{
+    TraceSpan(const char* name)
+        : name{name}
+    {
+        if (trace_func)
+        {
+            trace_func(trace_userdata, name, true);
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (trace_func)
+        {
+            trace_func(trace_userdata, name, false);
+        }
+    }
+
+    const char* name;
+};
+
 struct DebugGroup
 {
     DebugGroup(SDL_GPUCommandBuffer* command_buffer, const char* name)
         : command_buffer{command_buffer}
+        , trace_span{name}
     {
         SDLx_GPUBeginDebugGroup(command_buffer, name);
     }
@@ -43,6 +69,7 @@ struct DebugGroup
     }
 
     SDL_GPUCommandBuffer* command_buffer;
+    TraceSpan trace_span;
 };
 
 struct Buffer
@@ -286,6 +313,12 @@ typedef struct SDLx_GPURenderer
     std::vector<ModelData> model_requests;
 } SDLx_GPURenderer;
 
+void SDLx_GPUSetTraceFunction(SDLx_GPUTraceFunc func, void* userdata)
+{
+    trace_func = func;
+    trace_userdata = userdata;
+}
+
 SDL_GPUDevice* SDLx_GPUCreateDevice(bool low_power)
 {
     /* TODO: waiting on https://github.com/libsdl-org/SDL/issues/12056 for debugging */
@@ -1358,6 +1391,7 @@ SDLx_Model* SDLx_GPUGetModel(SDLx_GPURenderer* renderer, const char* path, SDLx_
 
 static void UploadText(SDLx_GPURenderer* renderer, size_t id, SDL_GPUCopyPass* copy_pass)
 {
+    TraceSpan trace_span("SDLx_gpu::UploadText");
     if (id == NullTextId)
     {
         return;
@@ -1671,35 +1705,43 @@ void SDLx_GPUSubmitRenderer(SDLx_GPURenderer* renderer, SDL_GPUCommandBuffer* co
         SDL_InvalidParamError("matrix_3d");
         return;
     }
-    SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(command_buffer);
-    if (!copy_pass)
-    {
-        SDL_Log("Failed to begin copy pass: %s", SDL_GetError());
-        return;
-    }
-    renderer->buffer_2d.Upload(renderer->device, copy_pass);
-    renderer->buffer_line_3d.Upload(renderer->device, copy_pass);
-    for (TextInstance2D& instance : renderer->text_instances_2d)
+    TraceSpan submit_span("SDLx_gpu::SubmitRenderer");
     {
-        UploadText(renderer, instance.id, copy_pass);
-    }
-    for (TextInstance3D& instance : renderer->text_instances_3d)
-    {
-        UploadText(renderer, instance.id, copy_pass);
-    }
-    for (ModelInstance& instance : renderer->model_instances)
-    {
-        renderer->model_requests.push_back(instance.data);
-    }
-    for (ModelData& data : renderer->model_requests)
-    {
-        auto& models = renderer->models[data.path];
-        if (!models[data.type])
+        TraceSpan trace_span("SDLx_gpu::CopyPass");
+        SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+        if (!copy_pass)
+        {
+            SDL_Log("Failed to begin copy pass: %s", SDL_GetError());
+            return;
+        }
         {
-            models[data.type] = SDLx_ModelLoad(renderer->device, copy_pass, data.path.data(), data.type);
+            TraceSpan trace_span("SDLx_gpu::UploadShapes");
+            renderer->buffer_2d.Upload(renderer->device, copy_pass);
+            renderer->buffer_line_3d.Upload(renderer->device, copy_pass);
+        }
+        for (TextInstance2D& instance : renderer->text_instances_2d)
+        {
+            UploadText(renderer, instance.id, copy_pass);
+        }
+        for (TextInstance3D& instance : renderer->text_instances_3d)
+        {
+            UploadText(renderer, instance.id, copy_pass);
+        }
+        for (ModelInstance& instance : renderer->model_instances)
+        {
+            renderer->model_requests.push_back(instance.data);
+        }
+        for (ModelData& data : renderer->model_requests)
+        {
+            auto& models = renderer->models[data.path];
+            if (!models[data.type])
+            {
+                TraceSpan trace_span("SDLx_ModelLoad");
+                models[data.type] = SDLx_ModelLoad(renderer->device, copy_pass, data.path.data(), data.type);
+            }
         }
+        SDL_EndGPUCopyPass(copy_pass);
     }
-    SDL_EndGPUCopyPass(copy_pass);
     SDL_GPUColorTargetInfo color_info{};
     color_info.texture = color_texture;
     color_info.load_op = SDL_GPU_LOADOP_LOAD;
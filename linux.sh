@@ -7,11 +7,12 @@ action=$1
 
 if [ "x$action" = "x" ]; then
     echo "Usage: $0 <action>" 1>&2
-    echo "  actions: build debug release run clean" 1>&2
+    echo "  actions: build debug release run bench clean" 1>&2
     echo "  debug: configure debug binary" 1>&2
     echo "  release: configure release binary" 1>&2
     echo "  build: configured binary - Debug if not configured" 1>&2
     echo "  run: run build locally" 1>&2
+    echo "  bench: run the engine benchmarks" 1>&2
     echo "  clean: clean up build output" 1>&2
     echo "  tags: run ctags on all source" 1>&2
     echo "  dos2unix: run dos2unix on all source files" 1>&2
@@ -38,6 +39,11 @@ run()
     (cd build/bin && ./crobots++ "$@")
 }
 
+bench()
+{
+    (cd build/bin && ./crobots_bench "$@")
+}
+
 clean()
 {
     rm -rf build tags *.log
@@ -60,6 +66,11 @@ case "$action" in
         run $@
         ;;
 
+    bench)
+        shift
+        bench $@
+        ;;
+
     clean)
         clean
         ;;
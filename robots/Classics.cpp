@@ -0,0 +1,97 @@
+#include <Crobots++/Crobots++.hpp>
+
+using namespace Crobots;
+
+// Classic style robots, two to a module: load them as Classics:Rook and Classics:Bishop.
+
+// A classic style robot: it drives back and forth along the middle of the arena, sweeping
+// its scanner around and firing at whatever it finds. Written as one endless loop, the
+// way robots were in the original game.
+class Rook : public ClassicRobot
+{
+public:
+    std::string_view GetName() const override
+    {
+        return "Rook";
+    }
+
+    void Run() override
+    {
+        float heading = 0;
+        float dir = 0;
+        Drive(heading, 50);
+        for (;;)
+        {
+            float range = Scan(dir, 10);
+            while (range > 0)
+            {
+                // Keep firing while it stays in the scanner.
+                Cannon(dir, range);
+                range = Scan(dir, 10);
+            }
+            dir = Mod360(dir + 10);
+
+            // Turn around at the walls.
+            if (heading == 0 && LocX() > GetArenaX() - 10)
+            {
+                Drive(heading, 0);
+                heading = 180;
+                Drive(heading, 50);
+            }
+            else if (heading == 180 && LocX() < 10)
+            {
+                Drive(heading, 0);
+                heading = 0;
+                Drive(heading, 50);
+            }
+        }
+    }
+};
+
+// Rook's companion: it runs diagonally from corner to corner, scanning in wide sweeps and
+// firing a single shot at anything it finds.
+class Bishop : public ClassicRobot
+{
+public:
+    std::string_view GetName() const override
+    {
+        return "Bishop";
+    }
+
+    void Run() override
+    {
+        float heading = 45;
+        float dir = 0;
+        Drive(heading, 50);
+        for (;;)
+        {
+            float range = Scan(dir, 10);
+            if (range > 0)
+            {
+                Cannon(dir, range);
+            }
+            else
+            {
+                dir = Mod360(dir + 20);
+            }
+
+            // Head back across the arena near a corner.
+            float x = LocX();
+            float y = LocY();
+            float next = heading;
+            if ((heading == 45 && (x > GetArenaX() - 10 || y > GetArenaY() - 10)) ||
+                (heading == 225 && (x < 10 || y < 10)))
+            {
+                next = Mod360(heading + 180);
+            }
+            if (next != heading)
+            {
+                Drive(heading, 0);
+                heading = next;
+                Drive(heading, 50);
+            }
+        }
+    }
+};
+
+CROBOTS_GETROBOTS(Rook, Bishop)
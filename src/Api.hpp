@@ -2,6 +2,9 @@
 
 #include <Crobots++/Crobots++.hpp>
 
+#include "CpuBudget.hpp"
+#include "Sandbox.hpp"
+
 namespace Crobots
 {
 
@@ -10,15 +13,38 @@ struct AppInfo
     std::string_view title;
     uint32_t arenaX;
     uint32_t arenaY;
-	uint32_t nrobots;
-	std::string robot1_path;
-	std::string robot2_path;
-	std::string robot3_path;
-	std::string robot4_path;
     bool debug;
     bool verbose;
     bool damage;
     bool pause_on_scan;
+    // Scan every robot rather than only those in the scan sector.
+    bool bruteForceScan;
+    // Seed for every random stream of the match (tournaments offset it per match).
+    uint64_t seed;
+    // Run without any rendering, as fast as possible.
+    bool headless;
+    // Stop after this many ticks, 0 to run until the game is over.
+    uint64_t maxTicks;
+    // Headless matches to run back to back on one engine, the seed counting up by one.
+    uint32_t matches;
+    // The robots of the match, one entry per robot, or those taking part in the tournament.
+    std::vector<std::string> robots;
+    // Round-robin tournament between the robots.
+    bool tournament;
+    uint32_t rounds;
+    // Worker threads for the tournament, 0 for one per hardware thread.
+    uint32_t threads;
+    // Threads that tick the robots of a match, 0 for one per hardware thread. With 1 they
+    // tick one after another on the engine's thread.
+    uint32_t robotThreads;
+    // Replay file for a headless match, or directory for a tournament's replays.
+    std::string replay;
+    // Where to write the match's tick profile, if anywhere.
+    std::string profileOut;
+    // CPU time robots may spend in Tick, for every match.
+    CpuBudget cpuBudget;
+    // Run every robot of a match in a child process of its own.
+    SandboxConfig sandbox;
 };
 
 }
@@ -1,19 +1,28 @@
 #include <SDL3/SDL.h>
 
+#include <chrono>
+
 #include "Api.hpp"
 #include "App.hpp"
 #include "Engine.hpp"
 #include "Loader.hpp"
+#include "ProfileReport.hpp"
 #include "Renderer.hpp"
 #include "Timer.hpp"
 
+namespace
+{
+
+static constexpr std::chrono::milliseconds TickPeriod{32};
+
+}
+
 namespace Crobots
 {
 
 App::App()
     : m_renderer{}
     , m_renderTimer{}
-    , m_engineTimer{}
     , m_shouldQuit{false}
 {
     m_engine = std::make_shared<Engine>();
@@ -24,34 +33,34 @@ bool App::Init(const AppInfo& info)
     SDL_SetAppMetadata(info.title.data(), nullptr, nullptr);
     if (!m_renderer.Init())
     {
-        CROBOTS_LOG("Failed to create renderer");
+        CROBOTS_LOG_ERROR(Render, "Failed to create renderer");
         return false;
     }
     m_renderTimer = Timer{16.6f};
-    m_engineTimer = Timer{32.0f};
 
-    CROBOTS_LOG("Creating arena dimensions {} and {}", info.arenaX, info.arenaY);
+    CROBOTS_LOG_INFO(Engine, "Creating arena dimensions {} and {}", info.arenaX, info.arenaY);
     Arena arena(info.arenaX, info.arenaY);
-    m_engine->Init(arena, info.debug, info.damage, info.pause_on_scan);
-    Loader loader(m_engine);
-	if (! loader.Load(info.robot1_path, 0))
-	{
-		std::cerr << "Failed to load " << info.robot1_path << std::endl;
-		return false;
-	}
-    if ((info.robot2_path.size() > 0) && (! loader.Load(info.robot2_path, 1)))
+    m_engine->Init(arena, info.debug, info.damage, info.pause_on_scan, info.seed);
+    m_engine->SetBruteForceScan(info.bruteForceScan);
+    m_engine->SetCpuBudget(info.cpuBudget);
+    m_engine->SetSandbox(info.sandbox);
+    if (info.robotThreads != 1)
     {
-        std::cerr << "Failed to load " << info.robot2_path << std::endl;
+        m_robotPool = std::make_unique<TaskPool>(info.robotThreads);
+        m_engine->SetTaskPool(m_robotPool.get());
     }
-    if ((info.robot3_path.size() > 0) && (! loader.Load(info.robot3_path, 2)))
+    Loader loader(m_engine);
+    if (!loader.Load(info.robots))
     {
-        std::cerr << "Failed to load " << info.robot3_path << std::endl;
+        return false;
     }
-    if ((info.robot4_path.size() > 0) && (! loader.Load(info.robot4_path, 3)))
+    m_engine->Load(loader.GetRobots());
+    m_profileOut = info.profileOut;
+    if (!m_profileOut.empty())
     {
-        std::cerr << "Failed to load " << info.robot4_path << std::endl;
+        m_engine->SetProfiler(&m_profiler);
     }
-    m_engine->Load(loader.GetRobots());
+    m_engineThread.Start(m_engine, TickPeriod);
     return true;
 }
 
@@ -62,20 +71,23 @@ bool App::ShouldQuit()
 
 void App::Quit()
 {
+    m_engineThread.Stop();
+    if (!m_profileOut.empty())
+    {
+        WriteProfile(m_profileOut, m_profiler, *m_engine);
+    }
     m_renderer.Quit();
 }
 
 void App::Iterate()
 {
     m_renderTimer.Tick();
-    m_engineTimer.Tick();
     if (m_renderTimer.ShouldTick())
     {
-        m_renderer.Present(m_engine, m_camera);
-    }
-    if (m_engineTimer.ShouldTick())
-    {
-        m_engine->Tick();
+        const Snapshot& snapshot = m_engineThread.GetSnapshot();
+        // Keeps presenting the final snapshot once the match is over, until
+        // the window is closed.
+        m_renderer.Present(snapshot, m_camera);
     }
 }
 
@@ -8,7 +8,10 @@
 #include "Api.hpp"
 #include "Camera.hpp"
 #include "Engine.hpp"
+#include "EngineThread.hpp"
+#include "Profiler.hpp"
 #include "Renderer.hpp"
+#include "TaskPool.hpp"
 #include "Timer.hpp"
 
 namespace Crobots
@@ -27,10 +30,16 @@ public:
 private:
     Renderer m_renderer;
     Timer m_renderTimer;
-    Timer m_engineTimer;
     bool m_shouldQuit;
     Camera m_camera;
+    // Workers the engine ticks robots on, when more than one robot thread was asked for.
+    std::unique_ptr<TaskPool> m_robotPool;
     std::shared_ptr<Engine> m_engine;
+    // Owns the engine once the match starts; the app only reads its snapshots.
+    EngineThread m_engineThread;
+    // Filled in by the engine thread, written out once it has stopped.
+    std::string m_profileOut;
+    Profiler m_profiler;
 };
 
 }
@@ -0,0 +1,131 @@
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Blasts.hpp"
+
+namespace
+{
+
+static constexpr float DeadDamage = 100.0f;
+
+}
+
+namespace Crobots
+{
+
+void Blasts::Add(float x, float y, float velocityX, float velocityY, float facing)
+{
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_velocityX.push_back(velocityX);
+    m_velocityY.push_back(velocityY);
+    m_facing.push_back(facing);
+}
+
+void Blasts::Clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_velocityX.clear();
+    m_velocityY.clear();
+    m_facing.clear();
+}
+
+void Blasts::Reserve(uint32_t count)
+{
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_velocityX.reserve(count);
+    m_velocityY.reserve(count);
+    m_facing.reserve(count);
+}
+
+uint32_t Blasts::GetCount() const
+{
+    return m_x.size();
+}
+
+float Blasts::GetDamage(uint32_t blast, float x, float y) const
+{
+    float dx = x - m_x[blast];
+    float dy = y - m_y[blast];
+    float distance2 = dx * dx + dy * dy;
+    // Outermost ring first, so the closest ring that applies wins.
+    float amount = distance2 <= BlastRadius[2] * BlastRadius[2] ? BlastDamage[2] : 0.0f;
+    amount = distance2 <= BlastRadius[1] * BlastRadius[1] ? BlastDamage[1] : amount;
+    amount = distance2 <= BlastRadius[0] * BlastRadius[0] ? BlastDamage[0] : amount;
+    return amount;
+}
+
+void Blasts::Resolve(const float* x, const float* y, float* damage, uint32_t count) const
+{
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    // Eight robots at a time, kept in registers while every blast is applied. Lanes compute
+    // exactly what ResolveScalar does, so results do not depend on which kernel ran.
+    const __m256 dead = _mm256_set1_ps(DeadDamage);
+    __m256 radius2[3];
+    __m256 ring[3];
+    for (uint32_t r = 0; r < 3; r++)
+    {
+        radius2[r] = _mm256_set1_ps(BlastRadius[r] * BlastRadius[r]);
+        ring[r] = _mm256_set1_ps(BlastDamage[r]);
+    }
+    uint32_t blasts = GetCount();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 rx = _mm256_loadu_ps(&x[i]);
+        __m256 ry = _mm256_loadu_ps(&y[i]);
+        __m256 hurt = _mm256_loadu_ps(&damage[i]);
+        for (uint32_t b = 0; b < blasts; b++)
+        {
+            __m256 dx = _mm256_sub_ps(rx, _mm256_set1_ps(m_x[b]));
+            __m256 dy = _mm256_sub_ps(ry, _mm256_set1_ps(m_y[b]));
+            __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            __m256 amount = _mm256_and_ps(_mm256_cmp_ps(distance2, radius2[2], _CMP_LE_OQ), ring[2]);
+            amount = _mm256_blendv_ps(amount, ring[1], _mm256_cmp_ps(distance2, radius2[1], _CMP_LE_OQ));
+            amount = _mm256_blendv_ps(amount, ring[0], _mm256_cmp_ps(distance2, radius2[0], _CMP_LE_OQ));
+            __m256 alive = _mm256_cmp_ps(hurt, dead, _CMP_LT_OQ);
+            __m256 after = _mm256_min_ps(_mm256_add_ps(hurt, amount), dead);
+            hurt = _mm256_blendv_ps(hurt, after, alive);
+        }
+        _mm256_storeu_ps(&damage[i], hurt);
+    }
+#endif
+    ResolveScalar(x, y, damage, i, count);
+}
+
+void Blasts::ResolveScalar(const float* x, const float* y, float* damage, uint32_t begin, uint32_t end) const
+{
+    // Blasts outside, robots inside and no branches, so the compiler can vectorize this too.
+    uint32_t blasts = GetCount();
+    for (uint32_t b = 0; b < blasts; b++)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            float amount = GetDamage(b, x[i], y[i]);
+            float hurt = damage[i];
+            float after = std::min(hurt + amount, DeadDamage);
+            damage[i] = hurt < DeadDamage ? after : hurt;
+        }
+    }
+}
+
+uint32_t Blasts::FindKiller(float x, float y, float damage) const
+{
+    // Replay the blasts in the order Resolve applied them.
+    for (uint32_t b = 0; b < GetCount() && damage < DeadDamage; b++)
+    {
+        damage = std::min(damage + GetDamage(b, x, y), DeadDamage);
+        if (damage >= DeadDamage)
+        {
+            return b;
+        }
+    }
+    return None;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Crobots
+{
+
+// Blast rings, as in classic Crobots: robots within BlastRadius[n] meters of a detonation
+// take BlastDamage[n] damage, the closest ring that reaches them counting.
+static constexpr float BlastRadius[] = {5.0f, 20.0f, 40.0f};
+static constexpr float BlastDamage[] = {10.0f, 5.0f, 3.0f};
+
+// The shots that detonate in one tick. They are resolved against every robot together:
+// each block of robots is loaded once and every blast is applied to it, so the cost is
+// a tight, branch-free loop over (robots x blasts) instead of a search per blast.
+class Blasts
+{
+public:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    // Add a detonation at (x, y) of a shot moving (velocityX, velocityY) per tick on facing.
+    void Add(float x, float y, float velocityX, float velocityY, float facing);
+    void Clear();
+    // Make room for count blasts in one tick.
+    void Reserve(uint32_t count);
+    uint32_t GetCount() const;
+    // Apply every blast, in order, to count robots at (x[i], y[i]). Robots already at 100
+    // damage are dead and left alone, and damage stops at 100.
+    void Resolve(const float* x, const float* y, float* damage, uint32_t count) const;
+    // The blast that took a robot at (x, y) from damage to 100, or None. Kills are rare, so
+    // Resolve leaves this out of the batched pass and it is worked out afterwards.
+    uint32_t FindKiller(float x, float y, float damage) const;
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+    std::vector<float> m_facing;
+
+private:
+    float GetDamage(uint32_t blast, float x, float y) const;
+    void ResolveScalar(const float* x, const float* y, float* damage, uint32_t begin, uint32_t end) const;
+};
+
+}
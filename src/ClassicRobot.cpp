@@ -0,0 +1,108 @@
+#include "Crobots++/ClassicRobot.hpp"
+
+#include "Coroutine.hpp"
+
+namespace Crobots
+{
+
+ClassicRobot::ClassicRobot()
+: m_calls{0}
+, m_scanned{false}
+, m_fired{false}
+, m_drove{false}
+{}
+
+ClassicRobot::~ClassicRobot() = default;
+
+void ClassicRobot::Tick()
+{
+    m_calls = 0;
+    m_scanned = false;
+    m_fired = false;
+    m_drove = false;
+    // The stack is made on the first tick, once the robot is fully constructed.
+    if (!m_coroutine)
+    {
+        m_coroutine = std::make_unique<Coroutine>([this] { Run(); });
+    }
+    m_coroutine->Resume();
+}
+
+void ClassicRobot::NextTick()
+{
+    m_coroutine->Suspend();
+}
+
+void ClassicRobot::Spend()
+{
+    if (m_calls == CallsPerTick)
+    {
+        NextTick();
+    }
+    m_calls++;
+}
+
+float ClassicRobot::Scan(float degree, float resolution)
+{
+    Spend();
+    while (m_scanned || !ScanReady())
+    {
+        NextTick();
+    }
+    m_scanned = true;
+    return IRobot::Scan(degree, resolution);
+}
+
+bool ClassicRobot::Cannon(float degree, float range)
+{
+    Spend();
+    if (m_fired)
+    {
+        NextTick();
+    }
+    m_fired = true;
+    return IRobot::Cannon(degree, range);
+}
+
+void ClassicRobot::Drive(float degree, float speed)
+{
+    Spend();
+    if (m_drove)
+    {
+        NextTick();
+    }
+    m_drove = true;
+    IRobot::Drive(degree, speed);
+}
+
+uint32_t ClassicRobot::Damage()
+{
+    Spend();
+    return IRobot::Damage();
+}
+
+float ClassicRobot::Speed()
+{
+    Spend();
+    return IRobot::Speed();
+}
+
+float ClassicRobot::LocX()
+{
+    Spend();
+    return IRobot::LocX();
+}
+
+float ClassicRobot::LocY()
+{
+    Spend();
+    return IRobot::LocY();
+}
+
+float ClassicRobot::Facing()
+{
+    Spend();
+    return IRobot::Facing();
+}
+
+}
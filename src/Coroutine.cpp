@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+
+#include "Crobots++/Log.hpp"
+#include "Coroutine.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#define CROBOTS_COROUTINE_FIBERS
+#elif defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define CROBOTS_COROUTINE_ASM
+#else
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#define CROBOTS_COROUTINE_UCONTEXT
+#endif
+
+#if defined(CROBOTS_COROUTINE_ASM)
+
+// Save the callee-saved registers on the current stack, store the stack pointer in *from,
+// switch to the stack at to and restore the registers saved there. A new stack is laid
+// out so that this "returns" into crobots_coroutine_entry with the coroutine in a
+// callee-saved register.
+extern "C" void crobots_switch_context(void** from, void* to);
+extern "C" void crobots_coroutine_entry();
+
+#if defined(__x86_64__)
+asm(R"(
+    .text
+    .globl crobots_switch_context
+    .hidden crobots_switch_context
+    .type crobots_switch_context, @function
+crobots_switch_context:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size crobots_switch_context, .-crobots_switch_context
+
+    .globl crobots_coroutine_entry
+    .hidden crobots_coroutine_entry
+    .type crobots_coroutine_entry, @function
+crobots_coroutine_entry:
+    movq %r12, %rdi
+    call crobots_coroutine_main
+    ud2
+    .size crobots_coroutine_entry, .-crobots_coroutine_entry
+)");
+#elif defined(__aarch64__)
+asm(R"(
+    .text
+    .globl crobots_switch_context
+    .hidden crobots_switch_context
+    .type crobots_switch_context, %function
+crobots_switch_context:
+    sub sp, sp, #160
+    stp x19, x20, [sp, #0]
+    stp x21, x22, [sp, #16]
+    stp x23, x24, [sp, #32]
+    stp x25, x26, [sp, #48]
+    stp x27, x28, [sp, #64]
+    stp x29, x30, [sp, #80]
+    stp d8, d9, [sp, #96]
+    stp d10, d11, [sp, #112]
+    stp d12, d13, [sp, #128]
+    stp d14, d15, [sp, #144]
+    mov x2, sp
+    str x2, [x0]
+    mov sp, x1
+    ldp x19, x20, [sp, #0]
+    ldp x21, x22, [sp, #16]
+    ldp x23, x24, [sp, #32]
+    ldp x25, x26, [sp, #48]
+    ldp x27, x28, [sp, #64]
+    ldp x29, x30, [sp, #80]
+    ldp d8, d9, [sp, #96]
+    ldp d10, d11, [sp, #112]
+    ldp d12, d13, [sp, #128]
+    ldp d14, d15, [sp, #144]
+    add sp, sp, #160
+    ret
+    .size crobots_switch_context, .-crobots_switch_context
+
+    .globl crobots_coroutine_entry
+    .hidden crobots_coroutine_entry
+    .type crobots_coroutine_entry, %function
+crobots_coroutine_entry:
+    mov x0, x19
+    bl crobots_coroutine_main
+    brk #0
+    .size crobots_coroutine_entry, .-crobots_coroutine_entry
+)");
+#endif
+
+#endif
+
+namespace Crobots
+{
+
+struct Coroutine::Context
+{
+#if defined(CROBOTS_COROUTINE_FIBERS)
+    void* fiber{nullptr};
+    void* caller{nullptr};
+#else
+    char* stack{nullptr};
+    size_t stackSize{0};
+#if defined(CROBOTS_COROUTINE_ASM)
+    void* sp{nullptr};
+    void* callerSp{nullptr};
+#else
+    ucontext_t context;
+    ucontext_t caller;
+#endif
+#endif
+
+    static void Start(Coroutine* coroutine)
+    {
+        Coroutine::Main(coroutine);
+    }
+
+#if defined(CROBOTS_COROUTINE_FIBERS)
+    static void WINAPI FiberStart(void* coroutine)
+    {
+        Start(static_cast<Coroutine*>(coroutine));
+    }
+#elif defined(CROBOTS_COROUTINE_UCONTEXT)
+    static void ContextStart(unsigned int high, unsigned int low)
+    {
+        // makecontext only passes ints.
+        Start(reinterpret_cast<Coroutine*>(static_cast<uintptr_t>((static_cast<uint64_t>(high) << 32) | low)));
+    }
+#endif
+};
+
+}
+
+#if defined(CROBOTS_COROUTINE_ASM)
+extern "C" __attribute__((visibility("hidden"), used)) void crobots_coroutine_main(Crobots::Coroutine* coroutine)
+{
+    Crobots::Coroutine::Context::Start(coroutine);
+}
+#endif
+
+namespace Crobots
+{
+
+Coroutine::Coroutine(Body body, size_t stackSize)
+: m_body{std::move(body)}
+, m_context{std::make_unique<Context>()}
+, m_done{false}
+{
+#if defined(CROBOTS_COROUTINE_FIBERS)
+    m_context->fiber = CreateFiber(stackSize, &Context::FiberStart, this);
+    assert( m_context->fiber != nullptr );
+#else
+    // Touched pages only, with a guard page below the stack so an overflow faults instead
+    // of scribbling over whatever is mapped there.
+    size_t page = sysconf(_SC_PAGESIZE);
+    stackSize = (stackSize + page - 1) / page * page;
+    m_context->stackSize = stackSize + page;
+    void* memory = mmap(nullptr, m_context->stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert( memory != MAP_FAILED );
+    mprotect(memory, page, PROT_NONE);
+    m_context->stack = static_cast<char*>(memory);
+    char* top = m_context->stack + m_context->stackSize;
+#if defined(CROBOTS_COROUTINE_ASM)
+    // The frame crobots_switch_context restores the first time it switches in.
+    void** frame;
+#if defined(__x86_64__)
+    // Control state, r15, r14, r13, r12 (the coroutine), rbx, rbp, return address.
+    frame = reinterpret_cast<void**>(top) - 8;
+    uint32_t control[2] = {0x1f80, 0x037f};
+    std::memcpy(frame, control, sizeof(control));
+    frame[4] = this;
+    frame[7] = reinterpret_cast<void*>(&crobots_coroutine_entry);
+#else
+    // x19 (the coroutine) to x28, x29, x30 (the return address), d8 to d15.
+    frame = reinterpret_cast<void**>(top) - 20;
+    std::fill(frame, frame + 20, nullptr);
+    frame[0] = this;
+    frame[11] = reinterpret_cast<void*>(&crobots_coroutine_entry);
+#endif
+    m_context->sp = frame;
+#else
+    getcontext(&m_context->context);
+    m_context->context.uc_stack.ss_sp = m_context->stack + page;
+    m_context->context.uc_stack.ss_size = stackSize;
+    m_context->context.uc_link = nullptr;
+    uint64_t self = reinterpret_cast<uintptr_t>(this);
+    makecontext(&m_context->context, reinterpret_cast<void (*)()>(&Context::ContextStart), 2,
+        static_cast<unsigned int>(self >> 32), static_cast<unsigned int>(self));
+#endif
+#endif
+}
+
+Coroutine::~Coroutine()
+{
+#if defined(CROBOTS_COROUTINE_FIBERS)
+    DeleteFiber(m_context->fiber);
+#else
+    munmap(m_context->stack, m_context->stackSize);
+#endif
+}
+
+void Coroutine::Resume()
+{
+    if (m_done)
+    {
+        return;
+    }
+#if defined(CROBOTS_COROUTINE_FIBERS)
+    m_context->caller = IsThreadAFiber() ? GetCurrentFiber() : ConvertThreadToFiber(nullptr);
+    SwitchToFiber(m_context->fiber);
+#elif defined(CROBOTS_COROUTINE_ASM)
+    crobots_switch_context(&m_context->callerSp, m_context->sp);
+#else
+    swapcontext(&m_context->caller, &m_context->context);
+#endif
+}
+
+void Coroutine::Suspend()
+{
+#if defined(CROBOTS_COROUTINE_FIBERS)
+    SwitchToFiber(m_context->caller);
+#elif defined(CROBOTS_COROUTINE_ASM)
+    crobots_switch_context(&m_context->sp, m_context->callerSp);
+#else
+    swapcontext(&m_context->context, &m_context->caller);
+#endif
+}
+
+bool Coroutine::IsDone() const
+{
+    return m_done;
+}
+
+void Coroutine::Main(Coroutine* coroutine)
+{
+    try
+    {
+        coroutine->m_body();
+    }
+    catch (const std::exception& e)
+    {
+        CROBOTS_LOG_ERROR(Robot, "coroutine ended with an exception: {}", e.what());
+    }
+    catch (...)
+    {
+        CROBOTS_LOG_ERROR(Robot, "coroutine ended with an exception");
+    }
+    coroutine->m_done = true;
+    // Nothing resumes a finished coroutine, so this never returns.
+    coroutine->Suspend();
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace Crobots
+{
+
+// A stackful coroutine: a body that runs on a small stack of its own and can suspend
+// itself at any depth, to carry on where it left off the next time it is resumed. On
+// x86-64 and AArch64 switching is a handful of register saves and restores in each
+// direction, with no system call; other platforms fall back to fibers or ucontext.
+// The coroutine may be resumed from a different thread each time, but never from two
+// at once.
+class Coroutine
+{
+public:
+    using Body = std::function<void()>;
+
+    static constexpr size_t DefaultStackSize = 64 * 1024;
+
+    explicit Coroutine(Body body, size_t stackSize = DefaultStackSize);
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+    // Frees the stack. Anything still on it is not destroyed.
+    ~Coroutine();
+
+    // Run the body until it suspends or returns. Does nothing once it has returned.
+    void Resume();
+    // Called from inside the body: return to whoever called Resume.
+    void Suspend();
+    bool IsDone() const;
+
+    struct Context;
+
+private:
+    static void Main(Coroutine* coroutine);
+
+    Body m_body;
+    std::unique_ptr<Context> m_context;
+    bool m_done;
+};
+
+}
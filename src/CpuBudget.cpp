@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "CpuBudget.hpp"
+
+namespace Crobots
+{
+
+uint64_t ThreadCpuNanoseconds()
+{
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    uint64_t k = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    uint64_t u = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    // FILETIME counts 100 ns intervals.
+    return (k + u) * 100;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+uint64_t SteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t CostHistogram::BucketOf(uint64_t ns)
+{
+    // Below SubCount every value has its own bucket; above, the top SubBits + 1 bits pick it.
+    if (ns < SubCount)
+    {
+        return ns;
+    }
+    uint32_t exponent = std::bit_width(ns) - 1;
+    uint32_t sub = (ns >> (exponent - SubBits)) & (SubCount - 1);
+    return (exponent - SubBits + 1) * SubCount + sub;
+}
+
+uint64_t CostHistogram::UpperBound(uint32_t bucket)
+{
+    if (bucket < SubCount)
+    {
+        return bucket;
+    }
+    uint32_t exponent = bucket / SubCount + SubBits - 1;
+    uint64_t sub = bucket % SubCount;
+    uint64_t lower = (SubCount + sub) << (exponent - SubBits);
+    return lower + (uint64_t{1} << (exponent - SubBits)) - 1;
+}
+
+void CostHistogram::Add(uint64_t ns)
+{
+    m_buckets[BucketOf(ns)]++;
+    m_count++;
+    m_total += ns;
+    m_max = std::max(m_max, ns);
+}
+
+uint64_t CostHistogram::GetPercentile(double p) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(std::clamp(p, 0.0, 1.0) * m_count));
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < BucketCount; bucket++)
+    {
+        seen += m_buckets[bucket];
+        if (seen >= rank)
+        {
+            return std::min(UpperBound(bucket), m_max);
+        }
+    }
+    return m_max;
+}
+
+uint64_t CostHistogram::GetMax() const
+{
+    return m_max;
+}
+
+uint64_t CostHistogram::GetTotal() const
+{
+    return m_total;
+}
+
+uint64_t CostHistogram::GetCount() const
+{
+    return m_count;
+}
+
+nlohmann::json TickCostJson(const RobotCpu& cpu)
+{
+    nlohmann::json result;
+    result["p50_ns"] = cpu.cost.GetPercentile(0.5);
+    result["p99_ns"] = cpu.cost.GetPercentile(0.99);
+    result["max_ns"] = cpu.cost.GetMax();
+    result["total_ns"] = cpu.cost.GetTotal();
+    result["overruns"] = cpu.overruns;
+    result["disqualified"] = cpu.disqualified;
+    return result;
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "json.hpp"
+
+namespace Crobots
+{
+
+// What happens to a robot whose Tick goes over budget.
+enum class BudgetPolicy
+{
+    // Log a warning and carry on.
+    Warn,
+    // Sit out the next CpuBudget::skipTicks ticks; once the match budget is spent, the rest
+    // of the match.
+    Skip,
+    // Out of the match: the robot is destroyed.
+    Disqualify,
+};
+
+// CPU time a robot may spend in Tick. Zero means no limit, and with no limits a match
+// stays reproducible from its seed; enforcing a budget depends on how fast the host is.
+struct CpuBudget
+{
+    uint64_t tickNs{0};
+    uint64_t matchNs{0};
+    BudgetPolicy policy{BudgetPolicy::Warn};
+    uint32_t skipTicks{10};
+};
+
+// CPU time used by the calling thread, in nanoseconds. Time the thread spends preempted
+// does not count, so robots are not charged for a busy host.
+uint64_t ThreadCpuNanoseconds();
+
+// Wall clock time from the steady clock, in nanoseconds: deadlines, and the reference the
+// cycle counters are calibrated against.
+uint64_t SteadyNanoseconds();
+
+// Log-linear histogram of durations in nanoseconds: eight buckets per power of two, so
+// percentiles are within 12.5% at any scale, in a fixed 2 KB.
+class CostHistogram
+{
+public:
+    void Add(uint64_t ns);
+    // The smallest recorded duration at or above fraction p (0 - 1) of the samples,
+    // rounded up to its bucket and never above the maximum.
+    uint64_t GetPercentile(double p) const;
+    uint64_t GetMax() const;
+    uint64_t GetTotal() const;
+    uint64_t GetCount() const;
+
+private:
+    static constexpr uint32_t SubBits = 3;
+    static constexpr uint32_t SubCount = 1 << SubBits;
+    static constexpr uint32_t BucketCount = (64 - SubBits + 1) * SubCount;
+
+    static uint32_t BucketOf(uint64_t ns);
+    static uint64_t UpperBound(uint32_t bucket);
+
+    std::array<uint32_t, BucketCount> m_buckets{};
+    uint64_t m_count{0};
+    uint64_t m_total{0};
+    uint64_t m_max{0};
+};
+
+// CPU accounting for one robot's Tick calls.
+struct RobotCpu
+{
+    CostHistogram cost;
+    uint32_t overruns{0};
+    // Not ticked before this tick.
+    uint64_t skipUntil{0};
+    // The match budget is spent.
+    bool exhausted{false};
+    bool disqualified{false};
+};
+
+// A robot's Tick cost over a match, as reported in match results.
+nlohmann::json TickCostJson(const RobotCpu& cpu);
+
+}
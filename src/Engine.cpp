@@ -1,6 +1,6 @@
-#include <cstdlib>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
-#include <ctime>
 #include <vector>
 #include <cassert>
 #include <numbers>
@@ -12,6 +12,49 @@
 #include "Api.hpp"
 #include "Arena.hpp"
 #include "Engine.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
+#include "Replay.hpp"
+#include "RobotStates.hpp"
+#include "TaskPool.hpp"
+
+namespace
+{
+
+// Random stream ids: one for the engine, then one per robot index.
+static constexpr uint64_t EngineStream = 0;
+static constexpr uint64_t RobotStream = 1;
+
+// Robots are circles of this radius (meters) when they run into each other, and each
+// collision costs both robots this much damage, as in classic Crobots.
+static constexpr float RobotRadius = 1.0f;
+static constexpr float CollisionDamage = 2.0f;
+
+// Scan candidates, hits and contacts reserved across all robots. A scan can find every
+// other robot, so a match of up to 512 robots gives each room for that; in bigger ones a
+// robot whose scans find more grows its buffers once.
+static constexpr size_t ScanReserve = 1 << 18;
+
+// Stands in for the other robots in a sandbox's copy of the match, where only the
+// sandbox's own robot ticks.
+class Absent : public Crobots::IRobot
+{
+public:
+    std::string_view GetName() const override { return "absent"; }
+    void Tick() override {}
+};
+
+float Mod360(float number)
+{
+    float result = fmod(number, 360.0f);
+    if (result < 0)
+    {
+        result += 360.0f;
+    }
+    return result;
+}
+
+}
 
 namespace Crobots
 {
@@ -31,37 +74,35 @@ float Position::GetY()
     return m_y;
 }
 
-const std::vector<Shot>& Engine::GetShots() const
+const ShotPool& Engine::GetShots() const
 {
     return m_shots;
 }
 
-void Engine::AddShot(Shot shot)
-{
-    m_shots.push_back(shot);
-}
-
 void Engine::AddShots()
 {
     // Check each robot for a pending shot.
-    for (auto& robot : m_robots)
+    for (uint32_t i = 0; i < m_robots.size(); i++)
     {
-        if (robot->IsDead())
+        IRobot* robot = m_robots[i].get();
+        if (m_states.m_damage[i] >= 100)
         {
             continue;
         }
         if (robot->m_cannotShotRegistered)
         {
-            CROBOTS_LOG("adding shot, initial position {}:{}",
-                robot->m_currentX, robot->m_currentY);
-            Shot shot(robot->m_currentX,
-                      robot->m_currentY,
-                      robot->m_cannonShotDegree,
-                      robot->m_cannonShotSpeed,
-                      robot->m_cannonShotRange);
-            AddShot(shot);
+            CROBOTS_LOG_DEBUG(Shots, "adding shot, initial position {}:{}",
+                m_states.m_currentX[i], m_states.m_currentY[i]);
+            TraceRecorder::Get().Instant("shot", "robot", i);
+            uint32_t id = m_shots.Add(m_states.m_currentX[i],
+                                      m_states.m_currentY[i],
+                                      robot->m_cannonShotDegree,
+                                      IRobot::GetActualSpeed(robot->m_cannonShotSpeed),
+                                      robot->m_cannonShotRange);
+            // The shot takes its first step this tick, so it arrives flight ticks - 1 from now.
+            m_detonations.Schedule(m_tick + m_shots.GetFlightTicks(m_shots.GetIndex(id)) - 1, id);
             robot->m_cannotShotRegistered = false;
-            robot->m_cannonTimeUntilReload = robot->m_cannonReloadTime;
+            m_states.m_reloadTick[i] = m_tick + robot->m_cannonReloadTime;
         }
     }
 }
@@ -73,13 +114,152 @@ bool Engine::DebugEnabled() const
 
 void Engine::DetonateShots()
 {
+    // Only the shots due this tick are looked at; the rest stay filed in the wheel.
+    m_dueShots.clear();
+    m_detonations.Collect(m_dueShots);
+    if (m_dueShots.empty())
+    {
+        return;
+    }
+    m_blasts.Clear();
+    for (uint32_t id : m_dueShots)
+    {
+        uint32_t index = m_shots.GetIndex(id);
+        // The last step may have overshot; the shot goes off where it was aimed.
+        float x = m_shots.m_targetX[index];
+        float y = m_shots.m_targetY[index];
+        CROBOTS_LOG_DEBUG(Shots, "shot detonating at {}:{}", x, y);
+        m_blasts.Add(x, y, m_shots.m_velocityX[index], m_shots.m_velocityY[index], m_shots.m_facing[index]);
+        m_shots.Remove(index);
+    }
+    if (!m_damage)
+    {
+        return;
+    }
+    // Robots are hit where they end this tick.
+    uint32_t count = m_states.GetCount();
+    m_damageBefore.assign(m_states.m_damage.begin(), m_states.m_damage.end());
+    m_blasts.Resolve(m_states.m_nextX.data(), m_states.m_nextY.data(), m_states.m_damage.data(), count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (m_damageBefore[i] >= 100 || m_states.m_damage[i] < 100)
+        {
+            continue;
+        }
+        uint32_t blast = m_blasts.FindKiller(m_states.m_nextX[i], m_states.m_nextY[i], m_damageBefore[i]);
+        CROBOTS_LOG_INFO(Shots, "{} destroyed by a shot at {}:{}", m_robots[i]->GetName(),
+            m_blasts.m_x[blast], m_blasts.m_y[blast]);
+        // The shell's momentum; every shell weighs the same for now.
+        struct DeathData ddata = {
+            DamageType::Cannon,
+            {
+                { m_blasts.m_velocityX[blast], m_blasts.m_velocityY[blast], 1, m_blasts.m_facing[blast] }
+            }
+        };
+        m_robots[i]->m_deathdata = ddata;
+        TraceRecorder::Get().Instant("death", "robot", i);
+    }
 }
 
 void Engine::GameOver()
 {
-    // We'll do more in the future. For now just shut down.
-    CROBOTS_LOG("Game over");
-    exit(0);
+    // The owner of the engine decides what to do next (quit the app, report a result, ...).
+    CROBOTS_LOG_INFO(Engine, "Game over at tick {}", m_tick);
+    m_gameOver = true;
+}
+
+bool Engine::IsGameOver() const
+{
+    return m_gameOver;
+}
+
+MatchResult Engine::RunMatch(uint64_t maxTicks)
+{
+    while (!m_gameOver && (maxTicks == 0 || m_tick < maxTicks))
+    {
+        Tick();
+    }
+    return GetResult();
+}
+
+MatchResult Engine::GetResult() const
+{
+    MatchResult result{m_tick, 0, std::nullopt, m_gameOver};
+    for (uint32_t i = 0; i < m_states.GetCount(); i++)
+    {
+        if (m_states.m_damage[i] < 100)
+        {
+            result.alive++;
+            result.winner = i;
+        }
+    }
+    if (result.alive != 1)
+    {
+        result.winner.reset();
+    }
+    // A match with a winner is over, whoever stopped ticking it.
+    result.gameOver = m_gameOver || result.winner.has_value();
+    return result;
+}
+
+uint64_t Engine::GetTick() const
+{
+    return m_tick;
+}
+
+uint32_t Engine::GetAliveCount() const
+{
+    return m_nRobotsAlive;
+}
+
+uint64_t Engine::GetSeed() const
+{
+    return m_seed;
+}
+
+const RobotStates& Engine::GetStates() const
+{
+    return m_states;
+}
+
+void Engine::SetRecorder(ReplayRecorder* recorder)
+{
+    m_recorder = recorder;
+}
+
+void Engine::SetCpuBudget(const CpuBudget& budget)
+{
+    m_budget = budget;
+}
+
+const RobotCpu& Engine::GetCpu(uint32_t index) const
+{
+    return m_cpu[index];
+}
+
+void Engine::SetSandbox(const SandboxConfig& config)
+{
+    m_sandbox = config;
+}
+
+void Engine::SetProfiler(Profiler* profiler)
+{
+    m_profiler = profiler;
+    if (m_profiler)
+    {
+        m_profiler->Resize(m_robots.size());
+    }
+}
+
+void Engine::SetTaskPool(TaskPool* pool)
+{
+    m_pool = pool;
+}
+
+uint32_t Engine::BoundedRand(uint32_t range)
+{
+    assert( range > 0 );
+    return m_random.Bounded(range);
 }
 
 const Arena& Engine::GetArena() const
@@ -105,54 +285,358 @@ const std::vector<std::shared_ptr<Crobots::IRobot>>& Engine::GetRobots() const
     return m_robots;
 }
 
-void Engine::Init(Crobots::Arena arena, bool debug, bool damage, bool pause_on_scan)
+void Engine::Init(Crobots::Arena arena, bool debug, bool damage, bool pause_on_scan, uint64_t seed)
 {
     m_arena = arena;
     m_debug = debug;
     m_damage = damage;
     m_pause_on_scan = pause_on_scan;
+    m_gameOver = false;
+    m_tick = 0;
+    m_nRobotsAlive = 0;
+    m_seed = seed;
+    m_random.Seed(seed, EngineStream);
+    m_detonations.Reset(0);
+    CROBOTS_LOG_INFO(Engine, "Engine::Init: seed {}", seed);
+}
+
+InternalRobotProxy* Engine::GetProxy(uint32_t id)
+{
+    while (m_proxies.size() <= id)
+    {
+        m_proxies.emplace_back(m_proxies.size(), this);
+    }
+    return &m_proxies[id];
 }
 
 void Engine::Load(std::vector<std::shared_ptr<Crobots::IRobot>>&& robots)
 {
-	CROBOTS_LOG("Engine::Load: nrobots = {}", robots.size());
+	CROBOTS_LOG_INFO(Engine, "Engine::Load: nrobots = {}", robots.size());
+    m_sandboxes.clear();
     m_robots = std::move(robots);
+    StartMatch();
+}
 
-    for (auto& robot : m_robots)
+void Engine::Reset(uint64_t seed)
+{
+    assert( !m_robots.empty() );
+    CROBOTS_LOG_INFO(Engine, "Engine::Reset: seed {}", seed);
+    m_seed = seed;
+    m_random.Seed(seed, EngineStream);
+    m_gameOver = false;
+    m_tick = 0;
+    m_pairTests = 0;
+    m_detonations.Reset(0);
+    m_shots.Clear();
+    m_blasts.Clear();
+    m_dueShots.clear();
+    m_collisions.clear();
+    for (std::shared_ptr<IRobot>& robot : m_robots)
     {
-        robot->m_indestructible = ! m_damage;
+        assert( robot->m_recreate != nullptr );
+        // Same memory, but only the pointer Recreate returns reaches the new robot.
+        IRobot* fresh = robot->m_recreate(robot.get());
+        robot = std::shared_ptr<IRobot>(robot, fresh);
     }
+    StartMatch();
+}
+
+void Engine::StartMatch()
+{
+    m_states.Resize(m_robots.size());
+
+    for (uint32_t i = 0; i < m_robots.size(); i++)
+    {
+        IRobot* robot = m_robots[i].get();
+        robot->m_states = &m_states;
+        robot->m_index = i;
+        // Scans look robots up by id, so the robot takes the proxy of its state index.
+        robot->m_proxy = GetProxy(i);
+        robot->SetId(i);
+        robot->m_random.Seed(m_seed, RobotStream + i);
+    }
+    m_nRobotsAlive = m_robots.size();
 
     PlaceRobots();
+    m_sweep.Resize(m_robots.size());
+    // Cleared rather than replaced, so a Reset keeps what they grew to.
+    m_scanCandidates.resize(m_robots.size());
+    m_scanHits.resize(m_robots.size());
+    for (std::vector<uint32_t>& hits : m_scanHits)
+    {
+        hits.clear();
+    }
+    m_cpu.assign(m_robots.size(), {});
+    if (m_profiler)
+    {
+        m_profiler->Resize(m_robots.size());
+    }
+    ReserveTickData();
+    m_grid.Init(m_arena.GetX(), m_arena.GetY(), m_robots.size());
+    UpdateGrid();
+    if (m_sandbox.enabled)
+    {
+        StartSandboxes();
+    }
 }
 
-void Engine::MoveShotsInFlight()
+void Engine::ReserveTickData()
+{
+    // A robot fires at most once a reload, and a shot aimed inside the arena lands within
+    // its diagonal. Shots aimed further out only make the buffers grow.
+    float diagonal = std::hypot(static_cast<float>(m_arena.GetX()), static_cast<float>(m_arena.GetY()));
+    uint32_t shots = 0;
+    for (const std::shared_ptr<IRobot>& robot : m_robots)
+    {
+        float speed = IRobot::GetActualSpeed(robot->m_cannonShotSpeed);
+        uint32_t flight = speed > 0 ? static_cast<uint32_t>(std::ceil(diagonal / speed)) : 1;
+        shots += flight / std::max(1u, robot->m_cannonReloadTime) + 1;
+    }
+    m_shots.Reserve(shots);
+    // Every shot in flight may go off in the same tick.
+    m_blasts.Reserve(shots);
+    m_dueShots.reserve(shots);
+    m_damageBefore.reserve(m_robots.size());
+    // Robots that do not overlap touch at most six others, so three pairs a robot. Robots
+    // placed on top of each other can make more, and grow the buffer once.
+    m_collisions.reserve(3 * m_robots.size());
+    // The grid's candidates may include the scanning robot itself, and robots in cells
+    // where two pieces of a wide scan meet twice. A Reset keeps what they grew to.
+    size_t scans = std::min<size_t>(m_robots.size(), ScanReserve / std::max<size_t>(1, m_robots.size()));
+    for (uint32_t i = 0; i < m_robots.size(); i++)
+    {
+        m_scanCandidates[i].reserve(2 * scans);
+        m_scanHits[i].reserve(scans);
+        m_robots[i]->m_contacts.reserve(scans);
+    }
+}
+
+void Engine::Unload()
+{
+    m_sandboxes.clear();
+    m_robots.clear();
+    m_states.Resize(0);
+    m_sweep.Resize(0);
+    m_scanCandidates.clear();
+    m_scanHits.clear();
+    m_cpu.clear();
+    m_shots.Clear();
+    m_detonations.Reset(m_tick);
+}
+
+void Engine::AccelRobots()
+{
+    uint32_t count = m_states.GetCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float& speed = m_states.m_speed[i];
+        float& facing = m_states.m_facing[i];
+        float desiredSpeed = m_states.m_desiredSpeed[i];
+        float desiredFacing = m_states.m_desiredFacing[i];
+        if (m_states.m_damage[i] >= 100)
+        {
+            speed = 0;
+            continue;
+        }
+        // Manage speed increase/decrease.
+        if (speed != desiredSpeed)
+        {
+            if (desiredSpeed > speed)
+            {
+                speed += m_states.m_acceleration[i];
+                if (speed > desiredSpeed)
+                {
+                    speed = desiredSpeed;
+                }
+            }
+            else
+            {
+                speed -= m_states.m_braking[i];
+                if (speed < desiredSpeed)
+                {
+                    speed = desiredSpeed;
+                }
+            }
+            CROBOTS_LOG_TRACE(Engine, "speed is now {}", speed);
+        }
+        // Manage facing changes.
+        if (desiredFacing != facing)
+        {
+            CROBOTS_LOG_TRACE(Engine, "desired facing is not our facing: {} vs {}", desiredFacing, facing);
+            // Turn left or right?
+            float diff = 0.0f;
+            if (desiredFacing > facing)
+            {
+                diff = desiredFacing - facing;
+                if (diff > 180.0f)
+                {
+                    // turn right
+                    facing -= m_states.m_turnRate[i];
+                    CROBOTS_LOG_TRACE(Engine, "right turn");
+                }
+                else
+                {
+                    // turn left
+                    facing += m_states.m_turnRate[i];
+                    CROBOTS_LOG_TRACE(Engine, "left turn");
+                }
+            }
+            else
+            {
+                diff = facing - desiredFacing;
+                if (diff > 180.0f)
+                {
+                    // turn left
+                    facing += m_states.m_turnRate[i];
+                    CROBOTS_LOG_TRACE(Engine, "left turn");
+                }
+                else
+                {
+                    // turn right
+                    facing -= m_states.m_turnRate[i];
+                    CROBOTS_LOG_TRACE(Engine, "right turn");
+                }
+            }
+            facing = Mod360(facing);
+            CROBOTS_LOG_TRACE(Engine, "post mod360: {}", facing);
+        }
+    }
+}
+
+void Engine::HitTheWall(uint32_t index)
 {
-    for (auto& shot : m_shots)
+    if (!m_damage)
+    {
+        return;
+    }
+    m_states.m_damage[index] += 5;
+    m_states.m_speed[index] = 0;
+    if (m_states.m_damage[index] >= 100)
     {
-        float currentX = shot.GetX();
-        float currentY = shot.GetY();
-        float facing = shot.GetFacing();
-        // FIXME: consolidate actual speed between IRobot and this method
-        float speed = IRobot::GetActualSpeed(shot.GetSpeed());
-        float radians = IRobot::ToRadians(facing);
-        float diffx = speed * std::cos(radians);
-        float diffy = speed * std::sin(radians);
-        CROBOTS_LOG("shot moving from {}:{} to {}:{} speed {}",
-            currentX, currentY, currentX+diffx, currentY+diffy, speed);
-        currentX += diffx;
-        currentY += diffy;
-        shot.SetX(currentX);
-        shot.SetY(currentY);
+        struct DeathData ddata = {
+            DamageType::HitWall,
+            {
+                { m_states.m_currentX[index], m_states.m_currentY[index], 100, m_states.m_facing[index] }
+            }
+        };
+        m_robots[index]->m_deathdata = ddata;
+        TraceRecorder::Get().Instant("death", "robot", index);
     }
 }
 
+void Engine::CollideRobots()
+{
+    m_pairTests = m_sweep.FindPairs(m_states.m_nextX.data(), m_states.m_nextY.data(), RobotRadius, m_collisions);
+    for (auto [a, b] : m_collisions)
+    {
+        if (m_states.m_damage[a] >= 100 || m_states.m_damage[b] >= 100)
+        {
+            continue;
+        }
+        // Robots that already touch may drive apart; only closing in counts as a collision.
+        float dx = m_states.m_currentX[b] - m_states.m_currentX[a];
+        float dy = m_states.m_currentY[b] - m_states.m_currentY[a];
+        float nextDx = m_states.m_nextX[b] - m_states.m_nextX[a];
+        float nextDy = m_states.m_nextY[b] - m_states.m_nextY[a];
+        if (nextDx * nextDx + nextDy * nextDy >= dx * dx + dy * dy)
+        {
+            continue;
+        }
+        CROBOTS_LOG_DEBUG(Engine, "{} and {} collided at {}:{}", m_robots[a]->GetName(), m_robots[b]->GetName(),
+            m_states.m_nextX[a], m_states.m_nextY[a]);
+        // Neither robot gets to make its move.
+        m_states.m_nextX[a] = m_states.m_currentX[a];
+        m_states.m_nextY[a] = m_states.m_currentY[a];
+        m_states.m_nextX[b] = m_states.m_currentX[b];
+        m_states.m_nextY[b] = m_states.m_currentY[b];
+        float speedA = m_states.m_speed[a];
+        float speedB = m_states.m_speed[b];
+        HitRobot(a, b, speedB);
+        HitRobot(b, a, speedA);
+    }
+}
+
+void Engine::HitRobot(uint32_t index, uint32_t other, float otherSpeed)
+{
+    if (!m_damage)
+    {
+        return;
+    }
+    m_states.m_damage[index] += CollisionDamage;
+    m_states.m_speed[index] = 0;
+    if (m_states.m_damage[index] >= 100)
+    {
+        // What ran into us; robots weigh as much as the wall for now.
+        float radians = IRobot::ToRadians(m_states.m_facing[other]);
+        float speed = IRobot::GetActualSpeed(otherSpeed);
+        struct DeathData ddata = {};
+        ddata.Type = DamageType::HitRobot;
+        ddata.CollisionData = { speed * std::cos(radians), speed * std::sin(radians), 100, m_states.m_facing[other] };
+        m_robots[index]->m_deathdata = ddata;
+        TraceRecorder::Get().Instant("death", "robot", index);
+    }
+}
+
+void Engine::MoveRobots()
+{
+    float arenaX = m_arena.GetX();
+    float arenaY = m_arena.GetY();
+    assert( arenaX > 0 );
+    assert( arenaY > 0 );
+
+    uint32_t count = m_states.GetCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (m_states.m_damage[i] >= 100)
+        {
+            continue;
+        }
+        // FIXME: refactor this with Engine::GetPositionAhead
+        float radians = IRobot::ToRadians(m_states.m_facing[i]);
+        float myspeed = IRobot::GetActualSpeed(m_states.m_speed[i]);
+        float x = myspeed * std::cos(radians);
+        float y = myspeed * std::sin(radians);
+        float nextX = m_states.m_currentX[i] + x;
+        float nextY = m_states.m_currentY[i] + y;
+        CROBOTS_LOG_TRACE(Engine, "speed is {}, x next {}, y next {}", myspeed, nextX, nextY);
+        // Boundary check.
+        if (nextX > arenaX)
+        {
+            nextX = arenaX;
+            HitTheWall(i);
+        }
+        else if (nextX < 1)
+        {
+            nextX = 1;
+            HitTheWall(i);
+        }
+        if (nextY > arenaY)
+        {
+            nextY = arenaY;
+            HitTheWall(i);
+        }
+        else if (nextY < 1)
+        {
+            nextY = 1;
+            HitTheWall(i);
+        }
+        assert( nextX > 0 );
+        assert( nextY > 0 );
+        m_states.m_nextX[i] = nextX;
+        m_states.m_nextY[i] = nextY;
+    }
+}
+
+void Engine::MoveShotsInFlight()
+{
+    m_shots.Integrate();
+}
+
 void Engine::PlaceRobots()
 {
     assert( m_arena.GetX() > 0 );
     assert( m_arena.GetY() > 0 );
-    std::srand(std::time(nullptr));
-    int count = 0;
+    uint32_t count = 0;
     for (std::shared_ptr<Crobots::IRobot>& robot : m_robots)
     {
         float x = 0;
@@ -165,18 +649,20 @@ void Engine::PlaceRobots()
                 x = 40;
                 y = 50;
             } else {
-                x = IRobot::BoundedRand(m_arena.GetX());
-                y = IRobot::BoundedRand(m_arena.GetY());
+                x = BoundedRand(m_arena.GetX());
+                y = BoundedRand(m_arena.GetY());
             }
         } else {
             // Start each robot at a random spot in the arena.
-            x = IRobot::BoundedRand(m_arena.GetX());
-            y = IRobot::BoundedRand(m_arena.GetY());
+            x = BoundedRand(m_arena.GetX());
+            y = BoundedRand(m_arena.GetY());
         }
-        CROBOTS_LOG("placing robot {} to initial location {}x{}",
+        CROBOTS_LOG_DEBUG(Engine, "placing robot {} to initial location {}x{}",
             robot->GetName(), x, y);
-        robot->m_currentX = x;
-        robot->m_currentY = y;
+        m_states.m_currentX[count] = x;
+        m_states.m_currentY[count] = y;
+        m_states.m_nextX[count] = x;
+        m_states.m_nextY[count] = y;
         count++;
     }
 }
@@ -185,7 +671,7 @@ float Engine::ScanResult(uint32_t robot_id, float scandir, float resolution) con
 {
     float result = 0;
 
-    CROBOTS_LOG("robot_id is {}", robot_id);
+    CROBOTS_LOG_TRACE(Scan, "robot_id is {}", robot_id);
 
     // Minimum resolution is 10.
     if (resolution < 10) {
@@ -198,62 +684,122 @@ float Engine::ScanResult(uint32_t robot_id, float scandir, float resolution) con
         return -1;
     }
 
-    float myX = m_robots[robot_id]->LocX();
-    float myY = m_robots[robot_id]->LocY();
+    if (m_profiler)
+    {
+        m_profiler->GetRobot(robot_id).scans++;
+    }
+    float myX = std::round(m_states.m_currentX[robot_id]);
+    float myY = std::round(m_states.m_currentY[robot_id]);
 
-    for (uint32_t i = 0; i < m_robots.size(); ++i)
+    // ScanRobot hits when the truncated angle difference d (folded to 360 - d past 180) is
+    // within half the resolution. For the angle t between target and scan direction that
+    // is |t| < lower or |t| >= upper, which maps to at most three ranges of bearings.
+    float half = resolution / 2;
+    float lower = std::floor(half) + 1;
+    float upper = std::ceil(360 - half);
+    bool sector = !m_bruteForceScan && std::isfinite(scandir) && std::abs(scandir) < 1e6f && lower < 180;
+    if (!sector)
+    {
+        for (uint32_t i = 0; i < m_robots.size(); ++i)
+        {
+            // Skip ourselves.
+            if (i == robot_id) {
+                continue;
+            }
+            ScanRobot(robot_id, i, myX, myY, scandir, resolution, result);
+        }
+        return result;
+    }
+
+    std::vector<uint32_t>& candidates = m_scanCandidates[robot_id];
+    candidates.clear();
+    double ranges[3][2] = {
+        { scandir - lower, scandir + lower },
+        { -180.0, scandir - upper },
+        { scandir + upper, 180.0 }
+    };
+    for (auto& range : ranges)
+    {
+        double lo = std::max(-180.0, range[0]);
+        double hi = std::min(180.0, range[1]);
+        if (lo <= hi)
+        {
+            m_grid.QueryCone(myX, myY, lo, hi, candidates);
+        }
+    }
+    // Contacts are recorded in robot order, as with a full sweep.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (uint32_t i : candidates)
     {
-        // Skip ourselves.
         if (i == robot_id) {
             continue;
         }
-        float theirX = m_robots[i]->LocX();
-        float theirY = m_robots[i]->LocY();
-        CROBOTS_LOG("my robot x/y = {}/{}, theirs x/y = {}/{}", myX, myY, theirX, theirY);
+        ScanRobot(robot_id, i, myX, myY, scandir, resolution, result);
+    }
+    return result;
+}
 
-        // Calculate the angle between the two robots.
-        float angle_between = atan2(theirY - myY, theirX - myX);
-        angle_between = IRobot::ToDegrees(angle_between);
-        CROBOTS_LOG("angle between two robots in degrees: {}", angle_between);
-        // Calculate angle difference.
-        int anglediff = std::abs(angle_between - scandir);
-        CROBOTS_LOG("anglediff is {}", anglediff);
-        // Normalize to 0 - 180
-        if (anglediff > 180) {
-            anglediff = 360 - anglediff;
-        }
+void Engine::ScanRobot(uint32_t robot_id, uint32_t index, float myX, float myY,
+                       float scandir, float resolution, float& result) const
+{
+    if (m_profiler)
+    {
+        m_profiler->GetRobot(robot_id).scanTests++;
+    }
+    float theirX = std::round(m_states.m_currentX[index]);
+    float theirY = std::round(m_states.m_currentY[index]);
+    CROBOTS_LOG_TRACE(Scan, "my robot x/y = {}/{}, theirs x/y = {}/{}", myX, myY, theirX, theirY);
+
+    // Calculate the angle between the two robots.
+    float angle_between = atan2(theirY - myY, theirX - myX);
+    angle_between = IRobot::ToDegrees(angle_between);
+    CROBOTS_LOG_TRACE(Scan, "angle between two robots in degrees: {}", angle_between);
+    // Calculate angle difference.
+    int anglediff = std::abs(angle_between - scandir);
+    CROBOTS_LOG_TRACE(Scan, "anglediff is {}", anglediff);
+    // Normalize to 0 - 180
+    if (anglediff > 180) {
+        anglediff = 360 - anglediff;
+    }
 
-        CROBOTS_LOG("anglediff is {}, resolution is {}", anglediff, resolution);
-        if (anglediff <= resolution / 2)
+    CROBOTS_LOG_TRACE(Scan, "anglediff is {}, resolution is {}", anglediff, resolution);
+    if (anglediff <= resolution / 2)
+    {
+        float distance = std::sqrt(std::pow(theirX - myX, 2) + std::pow(theirY - myY, 2));
+        CROBOTS_LOG_DEBUG(Scan, "Scanner contact: scandir = {}, distance = {}", scandir, distance);
+        if (m_pause_on_scan) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            CROBOTS_LOG_DEBUG(Scan, "Engine sleeping for 2s");
+        }
+        RecordHit(robot_id, index, myX, myY, theirX, theirY, scandir, distance);
+        // we have a hit we only return the closest one
+        if (result == 0) {
+            result = distance;
+        }
+        else if ((result > 0) && (result < distance))
         {
-            float distance = std::sqrt(std::pow(theirX - myX, 2) + std::pow(theirY - myY, 2));
-            CROBOTS_LOG("Scanner contact: scandir = {}, distance = {}", scandir, distance);
-            if (m_pause_on_scan) {
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                CROBOTS_LOG("Engine sleeping for 2s");
-            }
-            m_robots[i]->Detected();
-            // Need the original, unadjusted position.
-            theirX = m_robots[i]->LocX();
-            theirY = m_robots[i]->LocY();
-            std::unique_ptr<ContactDetails> contact = std::make_unique<ContactDetails>(myX,
-                                                                                       myY,
-                                                                                       theirX,
-                                                                                       theirY,
-                                                                                       scandir,
-                                                                                       distance);
-            m_robots[robot_id]->AddContact(contact);
-            // we have a hit we only return the closest one
-            if (result == 0) {
-                result = distance;
-            }
-            else if ((result > 0) && (result < distance))
-            {
-                result = distance;
-            }
+            result = distance;
         }
     }
-    return result;
+}
+
+void Engine::RecordHit(uint32_t robot_id, uint32_t index, float myX, float myY, float theirX, float theirY,
+                       float scandir, float distance) const
+{
+    // The target is another robot, possibly ticking on another thread; CommitScans
+    // tells it after every robot has ticked.
+    m_scanHits[robot_id].push_back(index);
+    if (m_profiler)
+    {
+        m_profiler->GetRobot(robot_id).contacts++;
+    }
+    m_robots[robot_id]->AddContact({myX, myY, theirX, theirY, scandir, distance});
+}
+
+void Engine::SetBruteForceScan(bool enabled)
+{
+    m_bruteForceScan = enabled;
 }
 
 void Position::SetX(float x)
@@ -268,52 +814,492 @@ void Position::SetY(float y)
 
 void Engine::Tick()
 {
-    CROBOTS_LOG("Engine::Tick");
-    for (std::shared_ptr<Crobots::IRobot>& robot : m_robots)
+    if (m_gameOver)
     {
-		CROBOTS_LOG("Engine looping on robot {}", robot->GetName());
-        // Reset any internal tick counters and state.
-        robot->TickInit();
-        // Run each robot through a tick.
-        robot->Tick();
-        // Update the position of each robot based on its velocity
-        robot->MoveRobot();
-        // Check for any loss of control (ie. skidding) - future item
-        // Update the velocity (ie. speed and facing) of each robot
-        robot->AccelRobot();
+        return;
     }
+    CROBOTS_LOG_TRACE(Engine, "Engine::Tick");
+    PhaseClock clock(m_profiler);
+    // Run the robots against the state of the last tick. They only write their own slots
+    // and intents, so this may run in parallel.
+    TickRobots();
+    clock.Lap(Phase::Robots);
+    // Apply what the robots did to each other, in robot order.
+    CommitScans();
+    clock.Lap(Phase::CommitScans);
+    CommitBudgets();
+    clock.Lap(Phase::CommitBudgets);
+    CommitSandboxes();
+    clock.Lap(Phase::CommitSandboxes);
+    // Update the position of each robot based on its velocity
+    MoveRobots();
+    clock.Lap(Phase::MoveRobots);
+    // Stop robots that would run into each other.
+    CollideRobots();
+    clock.Lap(Phase::CollideRobots);
+    // Check for any loss of control (ie. skidding) - future item
+    // Update the velocity (ie. speed and facing) of each robot
+    AccelRobots();
+    clock.Lap(Phase::AccelRobots);
 
     // Add any shots from robots firing now.
     AddShots();
+    clock.Lap(Phase::AddShots);
     // Update the position of any shots in flight
     MoveShotsInFlight();
+    clock.Lap(Phase::MoveShots);
 
     // Fire any direct fire weapons that have zero time of flight - future item
 
     // Detonate any shots that have reached their target
     DetonateShots();
+    clock.Lap(Phase::DetonateShots);
 
     // Update the arena.
     UpdateArena();
+    clock.Lap(Phase::UpdateArena);
+    m_tick++;
+    if (m_profiler)
+    {
+        m_profiler->AddTickCounts(m_pairTests, m_collisions.size(), m_shots.GetCount());
+    }
+
+    if (m_recorder)
+    {
+        m_recorder->Record(*this);
+    }
 }
 
-void Engine::UpdateArena()
+void Engine::TickRobot(uint32_t index)
 {
-    uint32_t nRobotsAlive = 0;
-    for (auto &robot : m_robots)
+    IRobot* robot = m_robots[index].get();
+    CROBOTS_LOG_TRACE(Engine, "Engine looping on robot {}", robot->GetName());
+    // Reset any internal tick counters and state.
+    robot->TickInit();
+    if (!CanTick(index))
     {
-        robot->m_currentX = robot->m_nextX;
-        robot->m_currentY = robot->m_nextY;
+        return;
+    }
+    // Run the robot through a tick, on the clock.
+    bool tracing = TraceRecorder::Get().IsRecording();
+    uint64_t scanTick = m_states.m_scanTick[index];
+    uint64_t cycles = m_profiler || tracing ? ReadCycles() : 0;
+    uint64_t start = ThreadCpuNanoseconds();
+    robot->Tick();
+    ChargeTick(index, ThreadCpuNanoseconds() - start);
+    if (m_profiler || tracing)
+    {
+        uint64_t end = ReadCycles();
+        if (m_profiler)
+        {
+            m_profiler->GetRobot(index).tick.Add(end - cycles);
+        }
+        TraceRecorder::Get().Complete("robot_tick", "robot", cycles, end, index);
+    }
+    // A robot from a module scans through the module's own copy of the engine code, and
+    // so of the trace recorder, which is never started. Its scan is recorded here, where
+    // the program's recorder is used: a robot scans at most once a tick, and a scan moves
+    // its scan deadline.
+    if (tracing && m_states.m_scanTick[index] != scanTick)
+    {
+        TraceRecorder::Get().Instant("scan", "robot", index);
+    }
+}
 
-        // Dead?
-        if (robot->m_damage < 100)
+bool Engine::CanTick(uint32_t index) const
+{
+    const RobotCpu& cpu = m_cpu[index];
+    return !cpu.disqualified && m_tick >= cpu.skipUntil;
+}
+
+void Engine::ChargeTick(uint32_t index, uint64_t cost)
+{
+    IRobot* robot = m_robots[index].get();
+    RobotCpu& cpu = m_cpu[index];
+    cpu.cost.Add(cost);
+    if (m_budget.tickNs > 0 && cost > m_budget.tickNs)
+    {
+        cpu.overruns++;
+        CROBOTS_LOG_WARN(Robot, "{} spent {} us in Tick, over its {} us budget", robot->GetName(),
+            cost / 1000, m_budget.tickNs / 1000);
+        OverBudget(index, m_tick + 1 + m_budget.skipTicks);
+    }
+    if (m_budget.matchNs > 0 && !cpu.exhausted && cpu.cost.GetTotal() > m_budget.matchNs)
+    {
+        cpu.exhausted = true;
+        CROBOTS_LOG_WARN(Robot, "{} has used up its {} ms of CPU for the match", robot->GetName(),
+            m_budget.matchNs / 1000000);
+        OverBudget(index, std::numeric_limits<uint64_t>::max());
+    }
+}
+
+void Engine::OverBudget(uint32_t index, uint64_t skipUntil)
+{
+    // Only this robot's own bookkeeping is touched here; CommitBudgets does the rest.
+    RobotCpu& cpu = m_cpu[index];
+    switch (m_budget.policy)
+    {
+    case BudgetPolicy::Warn:
+        break;
+    case BudgetPolicy::Skip:
+        cpu.skipUntil = std::max(cpu.skipUntil, skipUntil);
+        break;
+    case BudgetPolicy::Disqualify:
+        cpu.disqualified = true;
+        break;
+    }
+}
+
+void Engine::CommitBudgets()
+{
+    for (uint32_t i = 0; i < m_cpu.size(); i++)
+    {
+        if (!m_cpu[i].disqualified || m_states.m_damage[i] >= 100)
+        {
+            continue;
+        }
+        CROBOTS_LOG_INFO(Engine, "{} disqualified for going over its CPU budget", m_robots[i]->GetName());
+        m_states.m_damage[i] = 100;
+        m_states.m_speed[i] = 0;
+        struct DeathData ddata = {};
+        ddata.Type = DamageType::Disqualified;
+        m_robots[i]->m_deathdata = ddata;
+        TraceRecorder::Get().Instant("death", "robot", i);
+    }
+}
+
+void Engine::TickRobots()
+{
+    if (!m_sandboxes.empty())
+    {
+        TickSandboxes();
+        return;
+    }
+    uint32_t count = m_robots.size();
+    if (!m_pool || count < 2)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            TickRobot(i);
+        }
+        return;
+    }
+    // One task per worker; workers claim robots one at a time so a slow robot does not
+    // hold up the others queued behind it.
+    std::atomic<uint32_t> next{0};
+    uint32_t workers = std::min(m_pool->GetThreadCount(), count);
+    for (uint32_t w = 0; w < workers; w++)
+    {
+        m_pool->Submit([this, &next, count]
+        {
+            for (uint32_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            {
+                TickRobot(i);
+            }
+        });
+    }
+    m_pool->Wait();
+}
+
+bool Engine::StartSandboxHelper()
+{
+    return Sandbox::StartHelper(&Engine::RunSandbox);
+}
+
+void Engine::StartSandboxes()
+{
+    // After a Reset the children are still there, and start the next match in place. Only
+    // those whose robot crashed or hung are replaced.
+    bool reset = !m_sandboxes.empty();
+    for (uint32_t i = 0; i < m_robots.size(); i++)
+    {
+        // The last match collected every intent, so the ring is empty, unless the child
+        // wrote over it; then it is started again like one that crashed.
+        SandboxSnapshot* snapshot = reset && m_sandboxes[i]->IsRunning() ? m_sandboxes[i]->BeginSnapshot() : nullptr;
+        if (snapshot)
+        {
+            snapshot->reset = true;
+            snapshot->seed = m_seed;
+            m_sandboxes[i]->PostSnapshot();
+            continue;
+        }
+        if (!reset)
+        {
+            m_sandboxes.push_back(std::make_unique<Sandbox>(m_robots.size()));
+        }
+        SandboxSpec spec{};
+        spec.arenaX = m_arena.GetX();
+        spec.arenaY = m_arena.GetY();
+        spec.seed = m_seed;
+        spec.count = m_robots.size();
+        spec.index = i;
+        if (!Sandbox::DescribeFactory(m_robots[i]->m_create, spec) || !m_sandboxes[i]->Start(spec))
+        {
+            CROBOTS_LOG_ERROR(Engine, "Cannot sandbox {}, running every robot in process", m_robots[i]->GetName());
+            m_sandboxes.clear();
+            return;
+        }
+    }
+}
+
+void Engine::TickSandboxes()
+{
+    // The children work while we post to the others, so the robots tick side by side even
+    // without a task pool. Intents are applied in robot order.
+    uint32_t count = m_robots.size();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_robots[i]->TickInit();
+        if (CanTick(i) && m_sandboxes[i]->IsRunning())
+        {
+            PostSnapshot(i);
+        }
+    }
+    uint64_t deadline = SteadyNanoseconds() + m_sandbox.deadlineNs;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (CanTick(i) && m_sandboxes[i]->IsRunning())
+        {
+            CollectIntent(i, deadline);
+        }
+    }
+}
+
+void Engine::PostSnapshot(uint32_t index)
+{
+    Sandbox& sandbox = *m_sandboxes[index];
+    SandboxSnapshot* snapshot = sandbox.BeginSnapshot();
+    // The child takes every snapshot before it answers, so there is always room unless it
+    // wrote over the ring.
+    if (!snapshot)
+    {
+        CROBOTS_LOG_WARN(Robot, "{} left no room for its snapshot", m_robots[index]->GetName());
+        sandbox.Stop();
+        return;
+    }
+    uint32_t count = m_states.GetCount();
+    snapshot->tick = m_tick;
+    snapshot->seed = m_seed;
+    snapshot->reset = false;
+    snapshot->reloadTick = m_states.m_reloadTick[index];
+    snapshot->scanTick = m_states.m_scanTick[index];
+    snapshot->speed = m_states.m_speed[index];
+    snapshot->desiredSpeed = m_states.m_desiredSpeed[index];
+    snapshot->facing = m_states.m_facing[index];
+    snapshot->desiredFacing = m_states.m_desiredFacing[index];
+    snapshot->damage = m_states.m_damage[index];
+    snapshot->count = count;
+    snapshot->detected = m_robots[index]->m_detected;
+    std::copy_n(m_states.m_currentX.data(), count, snapshot->GetX());
+    std::copy_n(m_states.m_currentY.data(), count, snapshot->GetY());
+    sandbox.PostSnapshot();
+}
+
+void Engine::CollectIntent(uint32_t index, uint64_t deadlineNs)
+{
+    Sandbox& sandbox = *m_sandboxes[index];
+    IRobot* robot = m_robots[index].get();
+    const SandboxIntent* intent = sandbox.WaitIntent(deadlineNs);
+    if (!intent)
+    {
+        // CommitSandboxes takes the robot out of the match.
+        CROBOTS_LOG_WARN(Robot, "{} crashed or missed the {} ms tick deadline", robot->GetName(),
+            m_sandbox.deadlineNs / 1000000);
+        sandbox.Stop();
+        return;
+    }
+    // The child can still write to the intent, so every value is read once and the robots
+    // it names are checked before they are looked up.
+    uint32_t count = m_states.GetCount();
+    uint32_t hitCount = intent->hitCount;
+    const uint32_t* hits = intent->GetHits();
+    bool valid = hitCount < count;
+    for (uint32_t i = 0; i < hitCount && valid; i++)
+    {
+        uint32_t hit = hits[i];
+        valid = hit < count && hit != index;
+    }
+    if (!valid)
+    {
+        CROBOTS_LOG_WARN(Robot, "{} sent a scan with robots that are not in the match", robot->GetName());
+        sandbox.Stop();
+        return;
+    }
+    if (intent->scanTick != m_states.m_scanTick[index])
+    {
+        TraceRecorder::Get().Instant("scan", "robot", index);
+    }
+    m_states.m_desiredSpeed[index] = intent->desiredSpeed;
+    m_states.m_desiredFacing[index] = intent->desiredFacing;
+    m_states.m_scanTick[index] = intent->scanTick;
+    robot->m_scan_dir = intent->scanDir;
+    robot->m_resolution = intent->resolution;
+    robot->m_cannotShotRegistered = intent->shot;
+    robot->m_cannonShotDegree = intent->shotDegree;
+    robot->m_cannonShotRange = intent->shotRange;
+    // Rebuild the contacts the scan made in the child; both sides see the same positions.
+    float myX = std::round(m_states.m_currentX[index]);
+    float myY = std::round(m_states.m_currentY[index]);
+    for (uint32_t i = 0; i < hitCount; i++)
+    {
+        // Checked above, but the child may have changed it since.
+        uint32_t hit = hits[i];
+        if (hit >= count || hit == index)
         {
-            nRobotsAlive++;
+            continue;
         }
+        float theirX = std::round(m_states.m_currentX[hit]);
+        float theirY = std::round(m_states.m_currentY[hit]);
+        float distance = std::sqrt(std::pow(theirX - myX, 2) + std::pow(theirY - myY, 2));
+        RecordHit(index, hit, myX, myY, theirX, theirY, intent->scanDir, distance);
+    }
+    ChargeTick(index, intent->cpuNs);
+    sandbox.ReleaseIntent();
+}
+
+void Engine::RunSandbox(const SandboxSpec& spec, Sandbox& sandbox)
+{
+    // The parent has already logged setting up the very same match.
+    if (Internal::IsEnabled(LogLevel::Info, LogCategory::Engine))
+    {
+        Internal::SetLogLevel(LogCategory::Engine, LogLevel::Warn);
+    }
+    GetRobotFunc create = Sandbox::FindFactory(spec);
+    if (!create)
+    {
+        return;
+    }
+    Engine engine;
+    engine.Init(Arena(spec.arenaX, spec.arenaY), false, true, false, spec.seed);
+    std::vector<std::shared_ptr<IRobot>> robots;
+    for (uint32_t i = 0; i < spec.count; i++)
+    {
+        robots.emplace_back(i == spec.index ? create(engine.GetProxy(i)) : IRobot::Create<Absent>(engine.GetProxy(i)));
+    }
+    engine.Load(std::move(robots));
+    engine.ServeSandbox(spec.index, sandbox);
+}
+
+void Engine::ServeSandbox(uint32_t index, Sandbox& sandbox)
+{
+    // In the child: play this robot's ticks against the snapshots, forever. The rest of
+    // this copy of the engine only serves its scans.
+    IRobot* robot = m_robots[index].get();
+    for (;;)
+    {
+        const SandboxSnapshot* snapshot = sandbox.WaitSnapshot();
+        if (snapshot->reset)
+        {
+            // The next match, with the robot made again in place.
+            uint64_t seed = snapshot->seed;
+            sandbox.ReleaseSnapshot();
+            Reset(seed);
+            robot = m_robots[index].get();
+            continue;
+        }
+        uint32_t count = m_states.GetCount();
+        m_tick = snapshot->tick;
+        m_states.m_reloadTick[index] = snapshot->reloadTick;
+        m_states.m_scanTick[index] = snapshot->scanTick;
+        m_states.m_speed[index] = snapshot->speed;
+        m_states.m_desiredSpeed[index] = snapshot->desiredSpeed;
+        m_states.m_facing[index] = snapshot->facing;
+        m_states.m_desiredFacing[index] = snapshot->desiredFacing;
+        m_states.m_damage[index] = snapshot->damage;
+        std::copy_n(snapshot->GetX(), count, m_states.m_currentX.data());
+        std::copy_n(snapshot->GetY(), count, m_states.m_currentY.data());
+        robot->m_detected = snapshot->detected;
+        sandbox.ReleaseSnapshot();
+        UpdateGrid();
+
+        robot->TickInit();
+        uint64_t start = ThreadCpuNanoseconds();
+        robot->Tick();
+        uint64_t cost = ThreadCpuNanoseconds() - start;
+
+        SandboxIntent* intent = sandbox.BeginIntent();
+        assert( intent != nullptr );
+        std::vector<uint32_t>& hits = m_scanHits[index];
+        intent->scanTick = m_states.m_scanTick[index];
+        intent->cpuNs = cost;
+        intent->desiredSpeed = m_states.m_desiredSpeed[index];
+        intent->desiredFacing = m_states.m_desiredFacing[index];
+        intent->scanDir = robot->m_scan_dir;
+        intent->resolution = robot->m_resolution;
+        intent->shotDegree = robot->m_cannonShotDegree;
+        intent->shotRange = robot->m_cannonShotRange;
+        intent->hitCount = hits.size();
+        intent->shot = robot->m_cannotShotRegistered;
+        std::copy(hits.begin(), hits.end(), intent->GetHits());
+        hits.clear();
+        sandbox.PostIntent();
+    }
+}
+
+void Engine::CommitSandboxes()
+{
+    for (uint32_t i = 0; i < m_sandboxes.size(); i++)
+    {
+        if (m_sandboxes[i]->IsRunning() || m_states.m_damage[i] >= 100)
+        {
+            continue;
+        }
+        CROBOTS_LOG_INFO(Engine, "{} is out of the match, its sandbox is gone", m_robots[i]->GetName());
+        m_states.m_damage[i] = 100;
+        m_states.m_speed[i] = 0;
+        struct DeathData ddata = {};
+        ddata.Type = DamageType::Crashed;
+        m_robots[i]->m_deathdata = ddata;
+        TraceRecorder::Get().Instant("death", "robot", i);
+    }
+}
+
+void Engine::CommitScans()
+{
+    // A robot sees whether it was scanned during the previous tick.
+    for (std::shared_ptr<IRobot>& robot : m_robots)
+    {
+        robot->m_detected = false;
+    }
+    for (std::vector<uint32_t>& hits : m_scanHits)
+    {
+        for (uint32_t index : hits)
+        {
+            m_robots[index]->Detected();
+        }
+        hits.clear();
+    }
+}
+
+void Engine::UpdateGrid()
+{
+    // Robots only change bucket when they cross a cell edge, so this is mostly compares.
+    uint32_t count = m_states.GetCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_grid.Update(i, std::round(m_states.m_currentX[i]), std::round(m_states.m_currentY[i]));
+    }
+}
+
+void Engine::UpdateArena()
+{
+    uint32_t nRobotsAlive = 0;
+    uint32_t count = m_states.GetCount();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_states.m_currentX[i] = m_states.m_nextX[i];
+        m_states.m_currentY[i] = m_states.m_nextY[i];
+    }
+    UpdateGrid();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // Dead?
+        nRobotsAlive += m_states.m_damage[i] < 100;
     }
-    // The threshold to end the game is 1 living robot, but for now,
-    // for development, lets allow a single robot to run around.
-    if (nRobotsAlive < 1)
+    m_nRobotsAlive = nRobotsAlive;
+    // The match is over once at most one robot is left standing, but a match
+    // loaded with a single robot lets it run around, for development.
+    if (nRobotsAlive < 1 || (nRobotsAlive == 1 && count > 1))
     {
         GameOver();
     }
@@ -1,12 +1,23 @@
 #pragma once
 
 #include <Crobots++/IRobot.hpp>
+#include <Crobots++/InternalRobotProxy.hpp>
+#include <deque>
+#include <optional>
 #include <vector>
 #include <memory>
+#include <Crobots++/Random.hpp>
 
 #include "Api.hpp"
 #include "Arena.hpp"
-#include "Shot.hpp"
+#include "Blasts.hpp"
+#include "CpuBudget.hpp"
+#include "RobotStates.hpp"
+#include "Sandbox.hpp"
+#include "ShotPool.hpp"
+#include "SpatialGrid.hpp"
+#include "SweepAndPrune.hpp"
+#include "TimingWheel.hpp"
 
 // Lets talk about velocity.
 // I am modeling the arena dimensions after meters, so 100x100 is 100m on each side,
@@ -21,6 +32,10 @@
 namespace Crobots
 {
 
+class Profiler;
+class ReplayRecorder;
+class TaskPool;
+
 class Position
 {
 public:
@@ -34,6 +49,16 @@ private:
     float m_y;
 };
 
+// How a match ended, or how it stands if it has not.
+struct MatchResult
+{
+    uint64_t ticks;
+    uint32_t alive;
+    // The last robot standing, when exactly one is.
+    std::optional<uint32_t> winner;
+    bool gameOver;
+};
+
 class Engine
 {
 public:
@@ -41,15 +66,51 @@ public:
     Engine(const Engine&) = delete;
     const Engine& operator=(const Engine&) = delete;
 
-    void Init(Arena arena, bool debug, bool damage, bool pause_on_scan);
+    void Init(Arena arena, bool debug, bool damage, bool pause_on_scan, uint64_t seed);
+    // The proxy for the robot in slot id, to create the robot with. The engine owns it.
+    InternalRobotProxy* GetProxy(uint32_t id);
     void Load(std::vector<std::shared_ptr<IRobot>>&& robots);
+    // Release the robots (and with them the proxies that reference this engine).
+    void Unload();
+    // Start a new match with the loaded robots: each is made again in place, and every
+    // buffer the last match grew is reused, so back to back matches stop allocating.
+    void Reset(uint64_t seed);
     void Tick();
+    // Tick until the match is over or maxTicks ticks (0 for no limit) have been run.
+    MatchResult RunMatch(uint64_t maxTicks);
+    MatchResult GetResult() const;
     float ScanResult(uint32_t robot_id, float degree, float resolution) const;
-    void AddShot(Shot shot);
+    // Scan every robot instead of only those the spatial grid puts inside the scan sector.
+    // Results are identical either way; this is kept for verification and benchmarking.
+    void SetBruteForceScan(bool enabled);
     const Arena& GetArena() const;
     const std::vector<std::shared_ptr<IRobot>>& GetRobots() const;
-    const std::vector<Shot>& GetShots() const;
+    const ShotPool& GetShots() const;
     bool DebugEnabled() const;
+    // True once the end-of-match condition has been reached. Tick() is a no-op afterwards.
+    bool IsGameOver() const;
+    // Number of ticks run since Init().
+    uint64_t GetTick() const;
+    // Number of robots still alive after the last tick.
+    uint32_t GetAliveCount() const;
+    uint64_t GetSeed() const;
+    const RobotStates& GetStates() const;
+    // Record every tick from now on; nullptr stops recording. The engine does not own it.
+    void SetRecorder(ReplayRecorder* recorder);
+    // Tick the robots on this pool; nullptr ticks them one after another. Either way the
+    // match plays out the same. The engine does not own the pool.
+    void SetTaskPool(TaskPool* pool);
+    // Limit the CPU time robots may spend in Tick. Every Tick is timed either way.
+    void SetCpuBudget(const CpuBudget& budget);
+    const RobotCpu& GetCpu(uint32_t index) const;
+    // Time every phase of the tick and every robot's Tick, and count the work done, from
+    // now on; nullptr stops profiling. The engine does not own the profiler.
+    void SetProfiler(Profiler* profiler);
+    // Run each robot in a child process of its own from the next Load on.
+    void SetSandbox(const SandboxConfig& config);
+    // Start the helper sandboxes are forked from (see Sandbox::StartHelper). Call it at the
+    // top of main, before anything starts a thread; sandboxes cannot start without it.
+    static bool StartSandboxHelper();
 
     // This method is a utility method for computing a position a provided
     // distance along the current path of an object.
@@ -57,18 +118,89 @@ public:
 
 private:
     std::vector<std::shared_ptr<IRobot>> m_robots;
-    std::vector<Shot> m_shots;
+    // One per robot slot; a deque so the robots' pointers stay put as it grows.
+    std::deque<InternalRobotProxy> m_proxies;
+    RobotStates m_states;
+    ShotPool m_shots;
+    // Shot ids keyed by the tick they reach their target on.
+    TimingWheel m_detonations;
+    std::vector<uint32_t> m_dueShots;
+    // This tick's detonations, and robot damage before they went off.
+    Blasts m_blasts;
+    std::vector<float> m_damageBefore;
     Arena m_arena;
     bool m_debug;
     bool m_damage;
     bool m_pause_on_scan;
+    bool m_gameOver;
+    uint64_t m_tick;
+    uint32_t m_nRobotsAlive;
+    uint64_t m_seed;
+    // Engine-local random stream; robots get streams of the same seed, see Load().
+    Random m_random;
+    // Robots bucketed by rounded position, kept in step with m_states by UpdateArena.
+    SpatialGrid m_grid;
+    bool m_bruteForceScan{false};
+    // Robots sorted along X for collision checks, and this tick's overlapping pairs.
+    SweepAndPrune m_sweep;
+    std::vector<std::pair<uint32_t, uint32_t>> m_collisions;
+    ReplayRecorder* m_recorder{nullptr};
+    Profiler* m_profiler{nullptr};
+    // Circle tests made by the last collision check.
+    uint32_t m_pairTests{0};
+    TaskPool* m_pool{nullptr};
+    CpuBudget m_budget;
+    std::vector<RobotCpu> m_cpu;
+    SandboxConfig m_sandbox;
+    // One per robot when sandboxed, empty otherwise.
+    std::vector<std::unique_ptr<Sandbox>> m_sandboxes;
+    // Per robot: scratch for its scans, and the robots its scans hit this tick. Each is
+    // only touched by the robot's own Tick, so robots can tick in parallel.
+    mutable std::vector<std::vector<uint32_t>> m_scanCandidates;
+    mutable std::vector<std::vector<uint32_t>> m_scanHits;
 
+    // Bind the loaded robots to the engine and set up a match for them.
+    void StartMatch();
     // Initial random placement of the robots after loading.
     void PlaceRobots();
+    // Size the per-tick buffers for the loaded robots, so a match does not allocate as it
+    // gets busier.
+    void ReserveTickData();
+    uint32_t BoundedRand(uint32_t range);
+    void TickRobots();
+    void TickRobot(uint32_t index);
+    // Whether the robot gets to run its Tick this tick.
+    bool CanTick(uint32_t index) const;
+    // Account for cost nanoseconds of CPU spent in the robot's Tick.
+    void ChargeTick(uint32_t index, uint64_t cost);
+    void CommitScans();
+    void OverBudget(uint32_t index, uint64_t skipUntil);
+    void CommitBudgets();
+    void StartSandboxes();
+    // Tick every sandboxed robot: post all the snapshots, then collect the intents.
+    void TickSandboxes();
+    void PostSnapshot(uint32_t index);
+    void CollectIntent(uint32_t index, uint64_t deadlineNs);
+    // The robot's child process: make its copy of the match, then serve its ticks.
+    static void RunSandbox(const SandboxSpec& spec, Sandbox& sandbox);
+    void ServeSandbox(uint32_t index, Sandbox& sandbox);
+    void CommitSandboxes();
+    // Linear sweeps over m_states, one per phase of the tick.
+    void MoveRobots();
+    void AccelRobots();
+    void HitTheWall(uint32_t index);
+    void CollideRobots();
+    void HitRobot(uint32_t index, uint32_t other, float otherSpeed);
     void AddShots();
     void MoveShotsInFlight();
     void DetonateShots();
     void UpdateArena();
+    void UpdateGrid();
+    // Test robot index against a scan from (myX, myY), recording a contact on a hit.
+    void ScanRobot(uint32_t robot_id, uint32_t index, float myX, float myY,
+                   float scandir, float resolution, float& result) const;
+    void RecordHit(uint32_t robot_id, uint32_t index, float myX, float myY, float theirX, float theirY,
+                   float scandir, float distance) const;
     void GameOver();
 
 };
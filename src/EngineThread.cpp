@@ -0,0 +1,89 @@
+#include "EngineThread.hpp"
+#include "Trace.hpp"
+
+namespace
+{
+
+// The most ticks run back to back to catch up before the schedule is reset.
+static constexpr uint32_t MaxCatchUp = 5;
+
+}
+
+namespace Crobots
+{
+
+EngineThread::EngineThread()
+    : m_period{0}
+    , m_stop{false}
+{}
+
+EngineThread::~EngineThread()
+{
+    Stop();
+}
+
+void EngineThread::Start(std::shared_ptr<Engine> engine, std::chrono::nanoseconds period)
+{
+    m_engine = std::move(engine);
+    m_period = period;
+    m_stop = false;
+    // Have something to draw before the first tick.
+    m_snapshots.GetWriteBuffer().Capture(*m_engine);
+    m_snapshots.Publish();
+    m_thread = std::thread(&EngineThread::Run, this);
+}
+
+void EngineThread::Stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+const Snapshot& EngineThread::GetSnapshot()
+{
+    return m_snapshots.Acquire();
+}
+
+void EngineThread::Run()
+{
+    TraceRecorder::SetThreadName("engine");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    uint64_t ticks = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop && !m_engine->IsGameOver())
+    {
+        Clock::time_point due = start + ticks * m_period;
+        if (m_cv.wait_until(lock, due, [this] { return m_stop; }))
+        {
+            break;
+        }
+        lock.unlock();
+        uint32_t ran = 0;
+        while (Clock::now() >= start + ticks * m_period && ran < MaxCatchUp && !m_engine->IsGameOver())
+        {
+            m_engine->Tick();
+            m_snapshots.GetWriteBuffer().Capture(*m_engine);
+            m_snapshots.Publish();
+            ticks++;
+            ran++;
+        }
+        if (ran == MaxCatchUp && Clock::now() >= start + ticks * m_period)
+        {
+            CROBOTS_LOG_WARN(Engine, "Engine fell behind at tick {}, skipping ahead", m_engine->GetTick());
+            start = Clock::now();
+            ticks = 0;
+        }
+        lock.lock();
+    }
+}
+
+}
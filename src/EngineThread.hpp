@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Engine.hpp"
+#include "Snapshot.hpp"
+#include "TripleBuffer.hpp"
+
+namespace Crobots
+{
+
+// Ticks an engine at a fixed rate on its own thread, so rendering and event handling never
+// delay a tick and a stalled tick never freezes the window. Tick n is due at start + n
+// periods, in integer nanoseconds, so the rate does not drift; ticks missed while the
+// thread was held up are caught up, a few at a time, and after a long stall the schedule
+// restarts from now rather than racing through the backlog. A snapshot is published
+// after every tick; the engine itself must not be touched while the thread runs.
+class EngineThread
+{
+public:
+    EngineThread();
+    EngineThread(const EngineThread&) = delete;
+    EngineThread& operator=(const EngineThread&) = delete;
+    ~EngineThread();
+
+    void Start(std::shared_ptr<Engine> engine, std::chrono::nanoseconds period);
+    void Stop();
+    // The latest published snapshot, valid until the next call.
+    const Snapshot& GetSnapshot();
+
+private:
+    void Run();
+
+    std::shared_ptr<Engine> m_engine;
+    std::chrono::nanoseconds m_period;
+    TripleBuffer<Snapshot> m_snapshots;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop;
+};
+
+}
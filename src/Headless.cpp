@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "json.hpp"
+
+#include "Api.hpp"
+#include "Engine.hpp"
+#include "Headless.hpp"
+#include "Loader.hpp"
+#include "ProfileReport.hpp"
+
+namespace Crobots
+{
+
+Headless::Headless()
+    : m_maxTicks{0}
+    , m_matches{1}
+{
+    m_engine = std::make_shared<Engine>();
+}
+
+bool Headless::Init(const AppInfo& info)
+{
+    CROBOTS_LOG_INFO(Engine, "Creating headless arena dimensions {} and {}", info.arenaX, info.arenaY);
+    Arena arena(info.arenaX, info.arenaY);
+    m_engine->Init(arena, info.debug, info.damage, false, info.seed);
+    m_engine->SetBruteForceScan(info.bruteForceScan);
+    m_engine->SetCpuBudget(info.cpuBudget);
+    m_engine->SetSandbox(info.sandbox);
+    if (info.robotThreads != 1)
+    {
+        m_robotPool = std::make_unique<TaskPool>(info.robotThreads);
+        m_engine->SetTaskPool(m_robotPool.get());
+    }
+    m_maxTicks = info.maxTicks;
+    m_matches = std::max(1u, info.matches);
+    m_replay = info.replay;
+    m_profileOut = info.profileOut;
+    Loader loader(m_engine);
+    if (!loader.Load(info.robots))
+    {
+        return false;
+    }
+    m_engine->Load(loader.GetRobots());
+    if (!m_replay.empty())
+    {
+        if (!m_recorder.Start(m_replay, *m_engine))
+        {
+            std::cerr << "Failed to open replay " << m_replay << std::endl;
+            return false;
+        }
+        m_engine->SetRecorder(&m_recorder);
+    }
+    if (!m_profileOut.empty())
+    {
+        m_engine->SetProfiler(&m_profiler);
+    }
+    return true;
+}
+
+int Headless::Run()
+{
+    uint64_t seed = m_engine->GetSeed();
+    for (uint32_t match = 0; match < m_matches; match++)
+    {
+        if (match > 0)
+        {
+            m_engine->Reset(seed + match);
+        }
+        auto start = std::chrono::steady_clock::now();
+        MatchResult result = m_engine->RunMatch(m_maxTicks);
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        m_engine->SetRecorder(nullptr);
+        m_recorder.Finish();
+        if (!m_profileOut.empty() && !WriteProfile(m_profileOut, m_profiler, *m_engine))
+        {
+            std::cerr << "Failed to write profile " << m_profileOut << std::endl;
+        }
+        std::cout << ResultJson(result, elapsed).dump() << std::endl;
+    }
+    return 0;
+}
+
+nlohmann::json Headless::ResultJson(const MatchResult& match, double elapsed) const
+{
+    nlohmann::json result;
+    result["seed"] = m_engine->GetSeed();
+    result["ticks"] = match.ticks;
+    result["game_over"] = match.gameOver;
+    result["elapsed_seconds"] = elapsed;
+    result["ticks_per_second"] = elapsed > 0.0 ? match.ticks / elapsed : 0.0;
+    nlohmann::json robots = nlohmann::json::array();
+    for (uint32_t i = 0; i < m_engine->GetRobots().size(); i++)
+    {
+        const std::shared_ptr<IRobot>& robot = m_engine->GetRobots()[i];
+        nlohmann::json entry;
+        entry["id"] = robot->GetId();
+        entry["name"] = std::string(robot->GetName());
+        entry["x"] = robot->GetX();
+        entry["y"] = robot->GetY();
+        entry["damage"] = robot->GetDamage();
+        entry["alive"] = robot->GetDamage() < 100;
+        entry["tick_cost"] = TickCostJson(m_engine->GetCpu(i));
+        robots.push_back(entry);
+    }
+    result["robots"] = robots;
+    result["winner"] = match.winner ? nlohmann::json(*match.winner) : nlohmann::json(nullptr);
+    if (!m_replay.empty())
+    {
+        result["replay_bytes"] = m_recorder.GetBytesWritten();
+    }
+    return result;
+}
+
+}
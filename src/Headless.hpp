@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "json.hpp"
+
+#include "Api.hpp"
+#include "Engine.hpp"
+#include "Profiler.hpp"
+#include "Replay.hpp"
+#include "TaskPool.hpp"
+
+namespace Crobots
+{
+
+// Runs a match without any SDL video, TTF or GPU initialization. The engine is ticked
+// back-to-back as fast as the CPU allows and a JSON result is written to stdout. Several
+// matches reuse the one engine and print a line each.
+class Headless
+{
+public:
+    Headless();
+    bool Init(const AppInfo& info);
+    int Run();
+
+private:
+    // The match's result as printed.
+    nlohmann::json ResultJson(const MatchResult& match, double elapsed) const;
+
+    std::shared_ptr<Engine> m_engine;
+    uint64_t m_maxTicks;
+    uint32_t m_matches;
+    std::string m_replay;
+    ReplayRecorder m_recorder;
+    std::string m_profileOut;
+    Profiler m_profiler;
+    std::unique_ptr<TaskPool> m_robotPool;
+};
+
+}
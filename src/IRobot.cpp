@@ -7,45 +7,34 @@
 
 #include "Crobots++/Log.hpp"
 #include "Engine.hpp"
+#include "RobotStates.hpp"
 
 namespace Crobots {
 
-// Static members
-std::random_device IRobot::rd;
-std::mt19937 IRobot::gen(IRobot::rd());
-
 // API methods - Usable by any Robot - ie. protected
 //--------------------------------------------------
 
 IRobot::IRobot()
 {
-    CROBOTS_LOG("IRobot ctor()");
-    m_currentX = 0.0;
-    m_currentY = 0.0;
-    m_nextX = 0.0;
-    m_nextY = 0.0;
-    m_desiredSpeed = 0;
-    m_speed = 0;
-    m_desiredFacing = 0;
-    m_facing = 0;
-    m_damage = 0;
-    m_cannonTimeUntilReload = 0;
+    CROBOTS_LOG_DEBUG(Robot, "IRobot ctor()");
+    // The physical state is owned by the engine and bound in Engine::Load.
+    m_states = nullptr;
+    m_index = 0;
     // This will need to eventually use a unique robot profile, but for now
     // everyone gets the same attributes.
     m_rounds = 65535; // TODO: use std::numeric_limits<uint16_t>::max() or UINT16_MAX
-    m_acceleration = 1;
-    m_braking = 5;
-    m_turnRate = 5;
     m_cannonType = CannonType::Standard;
     m_cannonShotSpeed = 200;
     m_cannonReloadTime = 100;
     // For now everyone has the same scanner.
     m_ticksPerScan = 2;
-    m_scanCountDown = 0;
     m_scan_dir = 0;
     m_resolution =  0;
     m_detected = false;
-    m_indestructible = false;
+    m_cannotShotRegistered = false;
+    m_proxy = nullptr;
+    m_create = nullptr;
+    m_recreate = nullptr;
 
     m_deathdata = {
         DamageType::Alive,
@@ -57,20 +46,19 @@ IRobot::IRobot()
 
 IRobot::~IRobot()
 {
-    if (m_proxy != nullptr)
-    {
-        // break circular ref and let std::shared_ptr clean it up
-        m_proxy = nullptr;
-    }
+    // The proxy belongs to the engine.
+    m_proxy = nullptr;
 }
 
-void IRobot::AddContact(std::unique_ptr<ContactDetails>& contact)
+void IRobot::AddContact(const ContactDetails& contact)
 {
-    CROBOTS_LOG("New contact: {}", contact->ToString());
-    m_contacts.push_back(std::move(contact));
+    CROBOTS_LOG_DEBUG(Scan, "New contact: {} {} -> {} {} {} {}", contact.m_fromx, contact.m_fromy,
+                      contact.m_tox, contact.m_toy, contact.m_bearing, contact.m_range);
+    m_contacts.push_back(contact);
 }
 
-const std::vector<std::unique_ptr<ContactDetails>>& IRobot::GetContacts() {
+std::span<const ContactDetails> IRobot::GetContacts() const
+{
     return m_contacts;
 }
 
@@ -81,14 +69,14 @@ void IRobot::ClearContacts()
 
 float IRobot::LocX()
 {
-    assert( m_currentX > 0 );
-    return std::round(m_currentX);
+    assert( m_states->m_currentX[m_index] > 0 );
+    return std::round(m_states->m_currentX[m_index]);
 }
 
 float IRobot::LocY()
 {
-    assert( m_currentY > 0 );
-    return std::round(m_currentY);
+    assert( m_states->m_currentY[m_index] > 0 );
+    return std::round(m_states->m_currentY[m_index]);
 }
 
 uint32_t IRobot::GetId() const
@@ -105,17 +93,17 @@ void IRobot::SetId(uint32_t id)
 
 float IRobot::GetX() const
 {
-    return m_currentX;
+    return m_states->m_currentX[m_index];
 }
 
 float IRobot::GetY() const
 {
-    return m_currentY;
+    return m_states->m_currentY[m_index];
 }
 
 float IRobot::GetFacing() const
 {
-    return m_facing;
+    return m_states->m_facing[m_index];
 }
 
 float IRobot::GetScanDir() const
@@ -128,9 +116,14 @@ float IRobot::GetResolution() const
     return m_resolution;
 }
 
+float IRobot::GetDamage() const
+{
+    return m_states->m_damage[m_index];
+}
+
 float IRobot::GetDesiredFacing() const
 {
-    return m_desiredFacing;
+    return m_states->m_desiredFacing[m_index];
 }
 
 uint32_t IRobot::Rand(uint32_t limit)
@@ -140,7 +133,7 @@ uint32_t IRobot::Rand(uint32_t limit)
 
 uint32_t IRobot::Damage()
 {
-    return m_damage;
+    return m_states->m_damage[m_index];
 }
 
 struct DeathData IRobot::GetDeathData() const
@@ -155,17 +148,17 @@ void IRobot::SetDeathData(struct DeathData deathdata)
 
 float IRobot::Facing()
 {
-    return m_facing;
+    return m_states->m_facing[m_index];
 }
 
 float IRobot::Speed()
 {
-    return m_speed;
+    return m_states->m_speed[m_index];
 }
 
 void IRobot::Drive(float degree, float speed)
 {
-    CROBOTS_LOG("Drive: degree = {}, speed = {}", degree, speed);
+    CROBOTS_LOG_TRACE(Robot, "Drive: degree = {}, speed = {}", degree, speed);
     if (degree < 0)
     {
         degree = 0.0;
@@ -180,8 +173,8 @@ void IRobot::Drive(float degree, float speed)
     } else if (speed > 100) {
         speed = 100;
     }
-    m_desiredFacing = degree;
-    m_desiredSpeed = speed;
+    m_states->m_desiredFacing[m_index] = degree;
+    m_states->m_desiredSpeed[m_index] = speed;
 }
 
 float IRobot::Scan(float degree, float resolution)
@@ -190,32 +183,45 @@ float IRobot::Scan(float degree, float resolution)
     {
         degree -= 360.0;
     }
-    if (m_scanCountDown > 0)
+    assert( m_proxy != nullptr );
+    uint64_t tick = m_proxy->GetTick();
+    uint64_t& scanTick = m_states->m_scanTick[m_index];
+    if (tick < scanTick)
     {
-        m_scanCountDown--;
         return -1;
     }
-    m_scanCountDown = m_ticksPerScan;
+    scanTick = tick + m_ticksPerScan + 1;
     // FIXME: Should the scanner have a rate of rotation?
     m_scan_dir = degree;
     m_resolution = resolution;
     // We need to determine the bearing of each other robot to this one.
     // Once we have the bearing, based on 0 degrees to the right, and increasing counter-clockwise
     // to complete the circle, we can determine if the scan will ping off of one or more of them.
-    assert( m_proxy != nullptr );
     return m_proxy->ScanResult(GetId(), degree, resolution);
 }
 
 bool IRobot::Cannon(float degree, float range)
 {
-    if (m_cannonTimeUntilReload > 0)
+    assert( m_proxy != nullptr );
+    if (m_proxy->GetTick() < m_states->m_reloadTick[m_index])
     {
-        m_cannonTimeUntilReload--;
         return false;
     }
     return RegisterShot(m_cannonType, degree, range);
 }
 
+bool IRobot::ScanReady() const
+{
+    assert( m_proxy != nullptr );
+    return m_proxy->GetTick() >= m_states->m_scanTick[m_index];
+}
+
+bool IRobot::CannonReady() const
+{
+    assert( m_proxy != nullptr );
+    return m_proxy->GetTick() >= m_states->m_reloadTick[m_index];
+}
+
 // Note - The mathematical functions are not required due to the C++ standard library.
 // https://cppreference.com/w/cpp/numeric/math.html
 
@@ -237,154 +243,16 @@ bool IRobot::RegisterShot(CannonType weapon, float degree, float range)
 
 void IRobot::TickInit()
 {
+    // Reload and scan readiness are deadlines in RobotStates; nothing to count down here.
     m_cannotShotRegistered = false;
-    // Manage cannon reload time.
-    if (m_cannonTimeUntilReload > 0) {
-        m_cannonTimeUntilReload--;
-    }
-    m_detected = false;
+    // m_detected is set by Engine::CommitScans, from the scans of the last tick.
     ClearContacts();
 }
 //----------------------------------------------------------------------------------
 
-void IRobot::AccelRobot()
+bool IRobot::IsDead() const
 {
-    if (IsDead())
-    {
-        m_speed = 0;
-        return;
-    }
-    // Manage speed increase/decrease.
-    if (m_speed != m_desiredSpeed)
-    {
-        if (m_desiredSpeed > m_speed)
-        {
-            m_speed += m_acceleration;
-            if (m_speed > m_desiredSpeed)
-            {
-                m_speed = m_desiredSpeed;
-            }
-        }
-        else
-        {
-            m_speed -= m_braking;
-            if (m_speed < m_desiredSpeed)
-            {
-                m_speed = m_desiredSpeed;
-            }
-        }
-        CROBOTS_LOG("speed is now {}", m_speed);
-    }
-    // Manage facing changes.
-    if (m_desiredFacing != m_facing)
-    {
-        CROBOTS_LOG("desired facing is not our facing: {} vs {}", m_desiredFacing, m_facing);
-        // Turn left or right?
-        float diff = 0.0f;
-        if (m_desiredFacing > m_facing)
-        {
-            diff = m_desiredFacing - m_facing;
-            if (diff > 180.0f)
-            {
-                // turn right
-                m_facing -= m_turnRate;
-                CROBOTS_LOG("right turn");
-            }
-            else
-            {
-                // turn left
-                m_facing += m_turnRate;
-                CROBOTS_LOG("left turn");
-            }
-        }
-        else
-        {
-            diff = m_facing - m_desiredFacing;
-            if (diff > 180.0f)
-            {
-                // turn left
-                m_facing += m_turnRate;
-                CROBOTS_LOG("left turn");
-            }
-            else
-            {
-                // turn right
-                m_facing -= m_turnRate;
-                CROBOTS_LOG("right turn");
-            }
-        }
-        m_facing = Mod360(m_facing);
-        CROBOTS_LOG("post mod360: {}", m_facing);
-    }
-}
-
-void IRobot::MoveRobot()
-{
-    if (IsDead())
-    {
-        return;
-    }
-    float arenaX = m_proxy->GetArenaX();
-    float arenaY = m_proxy->GetArenaY();
-    assert( arenaX > 0 );
-    assert( arenaY > 0 );
-
-    // FIXME: refactor this with Engine::GetPositionAhead
-    float radians = ToRadians(m_facing);
-    float myspeed = GetActualSpeed(m_speed);
-    float x = myspeed * std::cos(radians);
-    float y = myspeed * std::sin(radians);
-    m_nextX = m_currentX + x;
-    m_nextY = m_currentY + y;
-    CROBOTS_LOG("speed is {}, x next {}, y next {}", myspeed, m_nextX, m_nextY);
-    // Boundary check.
-    if (m_nextX > arenaX)
-    {
-        m_nextX = arenaX;
-        HitTheWall();
-    }
-    else if (m_nextX < 1)
-    {
-        m_nextX = 1;
-        HitTheWall();
-    }
-    if (m_nextY > arenaY)
-    {
-        m_nextY = arenaY;
-        HitTheWall();
-    }
-    else if (m_nextY < 1)
-    {
-        m_nextY = 1;
-        HitTheWall();
-    }
-    assert( m_nextX > 0 );
-    assert( m_nextY > 0 );
-}
-
-void IRobot::HitTheWall()
-{
-    if (m_indestructible)
-    {
-        return;
-    }
-    m_damage += 5;
-    m_speed = 0;
-    if (m_damage >= 100)
-    {
-        struct DeathData ddata = {
-            DamageType::HitWall,
-            {
-                { GetX(), GetY(), 100, GetFacing() }
-            }
-        };
-        SetDeathData(ddata);
-    }
-}
-
-bool IRobot::IsDead()
-{
-    return m_damage >= 100;
+    return m_states->m_damage[m_index] >= 100;
 }
 
 float IRobot::ToDegrees(float radians)
@@ -429,14 +297,14 @@ bool IRobot::IsDetected() const
     return m_detected;
 }
 
-// static methods
 uint32_t IRobot::BoundedRand(uint32_t range)
 {
-    assert( range > 0 );
-    std::uniform_int_distribution<int> dist(1, range);
-    return dist(gen);
+    // Robots may ask for Rand(0); Bounded answers 0 rather than dividing by it.
+    return m_random.Bounded(range);
 }
 
+// static methods
+
 float IRobot::GetActualSpeed(float speed)
 {
     // speed is a percentage - FIXME: base this on the frame rate
@@ -5,7 +5,7 @@
 namespace Crobots
 {
 
-InternalRobotProxy::InternalRobotProxy(uint32_t id, std::shared_ptr<Engine> engine)
+InternalRobotProxy::InternalRobotProxy(uint32_t id, Engine* engine)
 : m_id(id)
 , m_engine(engine)
 {}
@@ -25,6 +25,11 @@ float InternalRobotProxy::ScanResult(uint32_t id, float degree, float resolution
     return m_engine->ScanResult(id, degree, resolution);
 }
 
+uint64_t InternalRobotProxy::GetTick() const
+{
+    return m_engine->GetTick();
+}
+
 uint32_t InternalRobotProxy::GetId() const
 {
     return m_id;
@@ -1,8 +1,7 @@
+#include <iostream>
 #include <memory>
+#include <unordered_map>
 
-#include <SDL3/SDL.h>
-
-#include "Crobots++/InternalRobotProxy.hpp"
 #include "Loader.hpp"
 
 namespace Crobots {
@@ -13,49 +12,47 @@ Loader::Loader(std::shared_ptr<Engine> engine)
 
 bool Loader::Load(const std::string& name, uint32_t id)
 {
-	CROBOTS_LOG("loading robot {}, id {}", name, id);
-    // This should not be a path. Reject anything that is.
-    if (name.size() == 0)
-    {
-        CROBOTS_LOG("Cannot load empty robot name");
-        return false;
-    }
-    if ((name[0] == '/') || (name[0] == '.'))
+	CROBOTS_LOG_INFO(Loader, "loading robot {}, id {}", name, id);
+    RobotFactory factory = LoadModule(name);
+    if (!factory)
     {
-        CROBOTS_LOG("Path characters not permitted in robot name");
-        return false;
-    }
-    std::string filename(name);
-#if defined(SDL_PLATFORM_WIN32)
-    filename += ".dll";
-    filename = ".\\" + filename;
-#elif defined(SDL_PLATFORM_APPLE)
-    filename = "lib" + filename + ".dylib";
-    filename = "./" + filename;
-#else
-    filename = "lib" + filename + ".so";
-    filename = "./" + filename;
-#endif
-    // FIXME: Unload when done?
-    SDL_SharedObject *plugin = SDL_LoadObject(filename.c_str());
-    if (!plugin)
-    {
-        CROBOTS_LOG("SDL_LoadObject failed on {}", filename);
         return false;
     }
+    return Create(factory, id);
+}
 
-    // Cast SDL_FunctionPointer to the correct function type
-    using GetRobotFunc = Crobots::IRobot* (*)(InternalRobotProxy* proxy);
-    GetRobotFunc fcn = reinterpret_cast<GetRobotFunc>(SDL_LoadFunction(plugin, "GetRobot"));
-    if (!fcn)
+bool Loader::Load(const std::vector<std::string>& names)
+{
+    std::unordered_map<std::string, RobotFactory> factories;
+    m_robots.reserve(m_robots.size() + names.size());
+    for (uint32_t id = 0; id < names.size(); id++)
     {
-        CROBOTS_LOG("Failed to find entry point in library");
-        return false;
+        auto [it, added] = factories.try_emplace(names[id]);
+        if (added)
+        {
+            CROBOTS_LOG_INFO(Loader, "loading robot {}", names[id]);
+            it->second = LoadModule(names[id]);
+        }
+        if (!it->second)
+        {
+            std::cerr << "Failed to load " << names[id] << std::endl;
+            return false;
+        }
+        Create(it->second, id);
     }
+    return true;
+}
 
-    InternalRobotProxy* proxy = new InternalRobotProxy(id, m_engine);
+RobotFactory Loader::LoadModule(const std::string& name)
+{
+    return ModuleRegistry::Get().Find(name);
+}
 
-    std::unique_ptr<Crobots::IRobot> robot(fcn(proxy));
+bool Loader::Create(const RobotFactory& factory, uint32_t id)
+{
+    // The robot's code lives in the module, so the module must outlive it.
+    std::shared_ptr<Crobots::IRobot> robot(factory.create(m_engine->GetProxy(id)),
+                                           [module = factory.module](Crobots::IRobot* robot) { delete robot; });
     m_robots.push_back(std::move(robot));
 
     return true;
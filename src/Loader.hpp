@@ -7,6 +7,7 @@
 #include <Crobots++/IRobot.hpp>
 
 #include "Engine.hpp"
+#include "ModuleRegistry.hpp"
 
 namespace Crobots {
 
@@ -16,12 +17,18 @@ public:
     Loader() = default;
     Loader(std::shared_ptr<Engine> engine);
 
-    /*
-     * Note: The user should provide robot names. Then based on the platform
-     * and a configured robots directory, we can find the appropriate file
-     * to load based on the platform and its naming convention for shared libraries.
-     */
+    // Look a robot up in the module registry, as "Module" or "Module:Class". The factory
+    // keeps its module loaded, so it can be used to create any number of robots.
+    static RobotFactory LoadModule(const std::string& name);
+
+    // Create the robot called name in the engine's slot id.
     bool Load(const std::string& name, uint32_t id);
+    // Create one robot per name, in slots 0 to names.size() - 1. Each distinct name is
+    // looked up once, however many copies of it there are. Fails if any robot does.
+    bool Load(const std::vector<std::string>& names);
+    // Create a robot from a factory previously returned by LoadModule. The robot keeps
+    // its module loaded until it is destroyed.
+    bool Create(const RobotFactory& factory, uint32_t id);
     std::vector<std::shared_ptr<Crobots::IRobot>>&& GetRobots();
 
 private:
@@ -1,15 +1,113 @@
 #include <SDL3/SDL.h>
 
 #include <string>
+#include <string_view>
 
 #include "Api.hpp"
 
+namespace
+{
+
+static constexpr const char* LogStateProperty = "crobots.log.state";
+
+static constexpr std::string_view LevelNames[] = {
+    "trace",
+    "debug",
+    "info",
+    "warn",
+    "error",
+    "off",
+};
+
+static constexpr SDL_LogPriority Priorities[] = {
+    SDL_LOG_PRIORITY_VERBOSE,
+    SDL_LOG_PRIORITY_DEBUG,
+    SDL_LOG_PRIORITY_INFO,
+    SDL_LOG_PRIORITY_WARN,
+    SDL_LOG_PRIORITY_ERROR,
+};
+
+template<size_t N>
+int Find(const std::string_view (&names)[N], std::string_view name)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        if (names[i] == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+}
+
 namespace Crobots::Internal
 {
 
-void Log(const std::string& string)
+LogState* ShareLogState()
 {
-    SDL_Log("%s", string.data());
+    SDL_PropertiesID properties = SDL_GetGlobalProperties();
+    void* state = SDL_GetPointerProperty(properties, LogStateProperty, nullptr);
+    if (!state)
+    {
+        state = &g_localLogState;
+        SDL_SetPointerProperty(properties, LogStateProperty, state);
+    }
+    return static_cast<LogState*>(state);
 }
 
-}
\ No newline at end of file
+void Log(LogLevel level, LogCategory category, const std::string& string)
+{
+    SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, Priorities[static_cast<size_t>(level)], "[%s] %s",
+        LogCategoryNames[static_cast<size_t>(category)].data(), string.data());
+}
+
+void SetLogLevel(LogCategory category, LogLevel level)
+{
+    g_logState->levels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+void SetLogSink(LogSink* sink)
+{
+    g_logState->sink.store(sink, std::memory_order_relaxed);
+}
+
+bool SetLogLevels(std::string_view spec)
+{
+    uint8_t levels[static_cast<size_t>(LogCategory::Count)];
+    for (size_t i = 0; i < std::size(levels); i++)
+    {
+        levels[i] = g_logState->levels[i].load(std::memory_order_relaxed);
+    }
+    while (!spec.empty())
+    {
+        size_t comma = spec.find(',');
+        std::string_view entry = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+        size_t equals = entry.find('=');
+        int level = Find(LevelNames, equals == std::string_view::npos ? entry : entry.substr(equals + 1));
+        if (level < 0)
+        {
+            return false;
+        }
+        if (equals == std::string_view::npos)
+        {
+            std::fill(std::begin(levels), std::end(levels), level);
+            continue;
+        }
+        int category = Find(LogCategoryNames, entry.substr(0, equals));
+        if (category < 0)
+        {
+            return false;
+        }
+        levels[category] = level;
+    }
+    for (size_t i = 0; i < std::size(levels); i++)
+    {
+        g_logState->levels[i].store(levels[i], std::memory_order_relaxed);
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,246 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Crobots++/LogRecord.hpp"
+
+// Renders a binary log written with --log-binary as the text log would have been, with the
+// time since startup in front of each event.
+
+namespace
+{
+
+using Crobots::Internal::LogArgType;
+using Crobots::Internal::LogCategoryNames;
+using Crobots::Internal::LogRecordType;
+
+struct Site
+{
+    uint8_t category;
+    uint32_t line;
+    std::string file;
+    std::string format;
+    std::string types;
+};
+
+class Reader
+{
+public:
+    Reader(const char* data, size_t size)
+        : m_data{data}
+        , m_size{size}
+        , m_offset{0}
+    {}
+
+    template<typename T>
+    bool Read(T& value)
+    {
+        if (m_size - m_offset < sizeof(T))
+        {
+            m_offset = m_size;
+            return false;
+        }
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    template<typename Length>
+    bool ReadString(std::string& value)
+    {
+        Length length = 0;
+        if (!Read(length) || m_size - m_offset < length)
+        {
+            m_offset = m_size;
+            return false;
+        }
+        value.assign(m_data + m_offset, length);
+        m_offset += length;
+        return true;
+    }
+
+    bool AtEnd() const
+    {
+        return m_offset >= m_size;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+template<typename T>
+std::string FormatArg(std::string_view spec, T value)
+{
+    try
+    {
+        return std::vformat(std::string("{") + std::string(spec) + "}", std::make_format_args(value));
+    }
+    catch (const std::format_error&)
+    {
+        return "?";
+    }
+}
+
+// Format one replacement field; spec includes the leading ':' if there is one.
+std::string FormatField(std::string_view spec, char type, Reader& arguments)
+{
+    switch (static_cast<LogArgType>(type))
+    {
+    case LogArgType::Bool: { uint8_t v = 0; return arguments.Read(v) ? FormatArg(spec, v != 0) : "?"; }
+    case LogArgType::Char: { char v = 0; return arguments.Read(v) ? FormatArg(spec, v) : "?"; }
+    case LogArgType::Int: { int64_t v = 0; return arguments.Read(v) ? FormatArg(spec, v) : "?"; }
+    case LogArgType::UInt: { uint64_t v = 0; return arguments.Read(v) ? FormatArg(spec, v) : "?"; }
+    case LogArgType::Float: { float v = 0; return arguments.Read(v) ? FormatArg(spec, v) : "?"; }
+    case LogArgType::Double: { double v = 0; return arguments.Read(v) ? FormatArg(spec, v) : "?"; }
+    case LogArgType::String:
+    {
+        std::string v;
+        return arguments.ReadString<uint16_t>(v) ? FormatArg(spec, std::string_view(v)) : "?";
+    }
+    }
+    return "?";
+}
+
+// Walk the format string, replacing each {} field with the next argument in turn.
+std::string Render(const Site& site, Reader arguments)
+{
+    std::string out;
+    std::string_view format = site.format;
+    size_t next = 0;
+    for (size_t i = 0; i < format.size(); i++)
+    {
+        char c = format[i];
+        if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c)
+        {
+            out += c;
+            i++;
+            continue;
+        }
+        if (c != '{')
+        {
+            out += c;
+            continue;
+        }
+        size_t end = format.find('}', i);
+        if (end == std::string_view::npos)
+        {
+            out += format.substr(i);
+            break;
+        }
+        std::string_view field = format.substr(i + 1, end - i - 1);
+        std::string_view spec = field.substr(std::min(field.find(':'), field.size()));
+        // Fields are stored in order, so only automatic numbering is supported.
+        out += next < site.types.size() ? FormatField(spec, site.types[next], arguments) : "?";
+        next++;
+        i = end;
+    }
+    return out;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: crobots_logdecode <binary log>" << std::endl;
+        return 1;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<char> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    if (data.size() < sizeof(Crobots::Internal::LogMagic) ||
+        std::memcmp(data.data(), Crobots::Internal::LogMagic, sizeof(Crobots::Internal::LogMagic)) != 0)
+    {
+        std::cerr << argv[1] << " is not a binary crobots++ log" << std::endl;
+        return 1;
+    }
+
+    Reader reader(data.data() + sizeof(Crobots::Internal::LogMagic), data.size() - sizeof(Crobots::Internal::LogMagic));
+    std::unordered_map<uint32_t, Site> sites;
+    std::string out;
+    bool truncated = false;
+    while (!reader.AtEnd() && !truncated)
+    {
+        LogRecordType type{};
+        reader.Read(type);
+        if (type == LogRecordType::Site)
+        {
+            uint32_t id = 0;
+            uint8_t level = 0;
+            uint8_t count = 0;
+            Site site{};
+            bool ok = reader.Read(id) && reader.Read(level) && reader.Read(site.category) &&
+                reader.Read(site.line) && reader.ReadString<uint16_t>(site.file) &&
+                reader.ReadString<uint16_t>(site.format) && reader.Read(count);
+            site.types.resize(count);
+            for (char& t : site.types)
+            {
+                ok = ok && reader.Read(t);
+            }
+            if (!ok)
+            {
+                truncated = true;
+                continue;
+            }
+            sites[id] = std::move(site);
+        }
+        else if (type == LogRecordType::Event)
+        {
+            uint32_t id = 0;
+            uint64_t time = 0;
+            std::string arguments;
+            if (!reader.Read(id) || !reader.Read(time) || !reader.ReadString<uint16_t>(arguments))
+            {
+                truncated = true;
+                continue;
+            }
+            auto it = sites.find(id);
+            if (it == sites.end())
+            {
+                std::cerr << "event for unknown site " << id << std::endl;
+                continue;
+            }
+            const Site& site = it->second;
+            std::string_view category = site.category < std::size(LogCategoryNames) ? LogCategoryNames[site.category] : "?";
+            out = std::format("{:.6f} [{}] [{}:{}] ", time / 1e9, category, site.file, site.line);
+            out += Render(site, Reader(arguments.data(), arguments.size()));
+            std::cout << out << '\n';
+        }
+        else if (type == LogRecordType::Text)
+        {
+            uint8_t priority = 0;
+            std::string text;
+            if (!reader.Read(priority) || !reader.ReadString<uint32_t>(text))
+            {
+                truncated = true;
+                continue;
+            }
+            std::cout << text << '\n';
+        }
+        else
+        {
+            std::cerr << "unknown record type " << static_cast<int>(type) << std::endl;
+            return 1;
+        }
+    }
+    if (truncated)
+    {
+        std::cerr << "log ends with a truncated record" << std::endl;
+    }
+    return 0;
+}
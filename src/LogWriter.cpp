@@ -0,0 +1,417 @@
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <exception>
+
+#include <unistd.h>
+
+#include "LogWriter.hpp"
+
+namespace
+{
+
+// The writer wakes up at least this often even if nobody signals it.
+static constexpr std::chrono::milliseconds FlushInterval{50};
+
+static Crobots::LogWriter* g_crashWriter = nullptr;
+static std::terminate_handler g_terminate = nullptr;
+
+// write(2) all of it, for the crash handler.
+void WriteAll(int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+}
+
+namespace Crobots
+{
+
+LogWriter::LogWriter()
+    : m_slots{std::make_unique<Slot[]>(Capacity)}
+    , m_tail{0}
+    , m_head{0}
+    , m_dropped{0}
+    , m_overflow{Overflow::Block}
+    , m_binary{false}
+    , m_sites{0}
+    , m_file{nullptr}
+    , m_fd{-1}
+    , m_sleeping{false}
+    , m_stop{false}
+{
+    for (uint32_t i = 0; i < Capacity; i++)
+    {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogWriter::~LogWriter()
+{
+    Stop();
+}
+
+bool LogWriter::Start(const std::string& path, Overflow overflow, bool binary)
+{
+    m_overflow = overflow;
+    m_binary = binary;
+    m_start = std::chrono::steady_clock::now();
+    m_file = std::fopen(path.c_str(), binary ? "wb" : "w");
+    if (m_file)
+    {
+        m_fd = fileno(m_file);
+    }
+    if (m_file && binary)
+    {
+        std::fwrite(Internal::LogMagic, 1, sizeof(Internal::LogMagic), m_file);
+        std::fflush(m_file);
+    }
+    m_thread = std::thread(&LogWriter::Run, this);
+    return m_file != nullptr;
+}
+
+void LogWriter::Stop()
+{
+    if (m_thread.joinable())
+    {
+        m_stop.store(true);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+    if (g_crashWriter == this)
+    {
+        g_crashWriter = nullptr;
+    }
+    if (m_file)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+        m_fd = -1;
+    }
+}
+
+void LogWriter::Write(int category, SDL_LogPriority priority, const char* message)
+{
+    char line[LineMax];
+    uint32_t length = FrameText(message, std::strlen(message), priority, line);
+    Enqueue(line, length, category, priority, false);
+}
+
+uint32_t LogWriter::FrameText(const char* message, size_t length, SDL_LogPriority priority, char* out) const
+{
+    if (!m_binary)
+    {
+        uint32_t size = std::min<size_t>(length, LineMax - 1);
+        std::memcpy(out, message, size);
+        out[size] = '\n';
+        return size + 1;
+    }
+    uint32_t size = std::min<size_t>(length, LineMax - TextHeader);
+    out[0] = static_cast<char>(Internal::LogRecordType::Text);
+    out[1] = static_cast<char>(priority);
+    std::memcpy(out + 2, &size, sizeof(size));
+    std::memcpy(out + TextHeader, message, size);
+    return TextHeader + size;
+}
+
+uint32_t LogWriter::RegisterSite(LogLevel level, LogCategory category, std::string_view file, uint32_t line,
+                                 std::string_view format, std::string_view types)
+{
+    uint32_t id = m_sites.fetch_add(1, std::memory_order_relaxed);
+    std::string record;
+    auto put = [&](const auto& value) {
+        record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    auto putString = [&](std::string_view string) {
+        uint16_t length = std::min<size_t>(string.size(), 1024);
+        put(length);
+        record.append(string.data(), length);
+    };
+    put(Internal::LogRecordType::Site);
+    put(id);
+    put(level);
+    put(category);
+    put(line);
+    putString(file);
+    putString(format);
+    put(static_cast<uint8_t>(types.size()));
+    record.append(types);
+    Enqueue(record.data(), record.size(), 0, SDL_LOG_PRIORITY_INFO, true);
+    return id;
+}
+
+void LogWriter::WriteEvent(uint32_t site, const char* arguments, uint32_t size)
+{
+    constexpr uint32_t Header = 1 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint16_t);
+    char record[Header + Internal::LogEventMax];
+    uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start).count();
+    uint16_t length = size;
+    record[0] = static_cast<char>(Internal::LogRecordType::Event);
+    std::memcpy(record + 1, &site, sizeof(site));
+    std::memcpy(record + 5, &time, sizeof(time));
+    std::memcpy(record + 13, &length, sizeof(length));
+    if (size > 0)
+    {
+        std::memcpy(record + Header, arguments, size);
+    }
+    Enqueue(record, Header + size, 0, SDL_LOG_PRIORITY_INFO, true);
+}
+
+void LogWriter::Enqueue(const char* data, uint32_t length, int category, SDL_LogPriority priority, bool record)
+{
+    uint32_t count = std::clamp((length + SlotText - 1) / SlotText, 1u, MaxSlotsPerLine);
+    if (!record)
+    {
+        length = std::min(length, count * SlotText);
+    }
+
+    // Claim count consecutive slots. The writer frees slots in order, so if the last one
+    // is free the ones before it are too.
+    uint64_t position = m_tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        uint64_t last = position + count - 1;
+        uint64_t sequence = m_slots[last % Capacity].sequence.load(std::memory_order_acquire);
+        if (sequence == last)
+        {
+            if (m_tail.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (sequence < last)
+        {
+            // Full.
+            if (m_overflow == Overflow::Drop && !record)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_cv.notify_one();
+            std::this_thread::yield();
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            // Another producer got there first.
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        Slot& slot = m_slots[(position + i) % Capacity];
+        uint32_t offset = i * SlotText;
+        slot.category = category;
+        slot.priority = priority;
+        slot.length = std::min(SlotText, length - offset);
+        slot.more = i + 1 < count;
+        slot.record = record;
+        std::memcpy(slot.text, data + offset, slot.length);
+        slot.sequence.store(position + i + 1, std::memory_order_release);
+    }
+
+    // Pairs with the fence in Run(): either the writer sees our slots before it sleeps, or
+    // we see that it is sleeping and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed))
+    {
+        m_cv.notify_one();
+    }
+}
+
+uint64_t LogWriter::GetDropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void LogWriter::Output(void* userdata, int category, SDL_LogPriority priority, const char* message)
+{
+    static_cast<LogWriter*>(userdata)->Write(category, priority, message);
+}
+
+void LogWriter::Run()
+{
+    while (true)
+    {
+        while (Drain())
+        {
+        }
+        if (m_stop.load())
+        {
+            // Producers may still have been writing while we were asked to stop.
+            while (Drain())
+            {
+            }
+            break;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t sequence = m_slots[m_head % Capacity].sequence.load(std::memory_order_relaxed);
+        if (sequence != m_head + 1 && !m_stop.load())
+        {
+            m_cv.wait_for(lock, FlushInterval);
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+bool LogWriter::Drain()
+{
+    if (m_draining.test_and_set(std::memory_order_acquire))
+    {
+        return false;
+    }
+    m_batch.clear();
+    uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0)
+    {
+        std::string line = "[log] " + std::to_string(dropped) + " messages dropped";
+        SDL_GetDefaultLogOutputFunction()(nullptr, SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN, line.c_str());
+        char framed[LineMax];
+        m_batch.append(framed, FrameText(line.data(), line.size(), SDL_LOG_PRIORITY_WARN, framed));
+    }
+    while (true)
+    {
+        Slot& slot = m_slots[m_head % Capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != m_head + 1)
+        {
+            break;
+        }
+        m_line.append(slot.text, slot.length);
+        int category = slot.category;
+        SDL_LogPriority priority = slot.priority;
+        bool more = slot.more;
+        bool record = slot.record;
+        slot.sequence.store(m_head + Capacity, std::memory_order_release);
+        m_head++;
+        if (more)
+        {
+            continue;
+        }
+        m_batch += m_line;
+        if (!record)
+        {
+            // Echo the line without its framing.
+            if (!m_binary)
+            {
+                m_line.pop_back();
+            }
+            SDL_GetDefaultLogOutputFunction()(nullptr, category, priority, m_line.c_str() + (m_binary ? TextHeader : 0));
+        }
+        m_line.clear();
+    }
+    bool wrote = !m_batch.empty();
+    Flush();
+    m_draining.clear(std::memory_order_release);
+    return wrote;
+}
+
+void LogWriter::Flush()
+{
+    if (m_file && !m_batch.empty())
+    {
+        std::fwrite(m_batch.data(), 1, m_batch.size(), m_file);
+        std::fflush(m_file);
+    }
+}
+
+void LogWriter::FlushOnCrash()
+{
+    g_crashWriter = this;
+    for (int signal : {SIGSEGV, SIGABRT, SIGFPE, SIGILL})
+    {
+        std::signal(signal, &LogWriter::CrashHandler);
+    }
+    g_terminate = std::set_terminate([] {
+        if (g_crashWriter)
+        {
+            g_crashWriter->WriteOutOnCrash();
+        }
+        if (g_terminate)
+        {
+            g_terminate();
+        }
+        std::abort();
+    });
+}
+
+void LogWriter::CrashHandler(int signal)
+{
+    if (LogWriter* writer = g_crashWriter)
+    {
+        writer->WriteOutOnCrash();
+    }
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+void LogWriter::WriteOutOnCrash()
+{
+    // Best effort: the writer thread may be mid-batch, in which case give it a moment to
+    // finish. If it never does, it is most likely the thread that crashed.
+    timespec pause{0, 1000000};
+    for (int attempt = 0; m_draining.test_and_set(std::memory_order_acquire); attempt++)
+    {
+        if (attempt == 100)
+        {
+            return;
+        }
+        nanosleep(&pause, nullptr);
+    }
+    // Every batch is flushed before m_draining is cleared, so nothing is left in m_file's
+    // buffer. A line still being published is left out rather than written in part.
+    uint64_t written = m_head;
+    for (uint64_t position = m_head;
+         m_slots[position % Capacity].sequence.load(std::memory_order_acquire) == position + 1; position++)
+    {
+        if (m_slots[position % Capacity].more)
+        {
+            continue;
+        }
+        // Text lines are echoed too, without their record header in binary mode.
+        bool echo = !m_slots[position % Capacity].record;
+        for (uint64_t first = written; written <= position; written++)
+        {
+            const Slot& slot = m_slots[written % Capacity];
+            if (m_fd >= 0)
+            {
+                WriteAll(m_fd, slot.text, slot.length);
+            }
+            if (echo)
+            {
+                uint32_t skip = m_binary && written == first ? TextHeader : 0;
+                WriteAll(STDERR_FILENO, slot.text + skip, slot.length - skip);
+            }
+        }
+        if (echo && m_binary)
+        {
+            WriteAll(STDERR_FILENO, "\n", 1);
+        }
+    }
+    m_head = written;
+    m_draining.clear(std::memory_order_release);
+}
+
+}
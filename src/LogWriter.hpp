@@ -0,0 +1,121 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Crobots++/Log.hpp"
+
+namespace Crobots
+{
+
+// Takes log lines off the calling thread. Producers copy each line into a bounded
+// lock-free ring and return; a writer thread drains the ring in batches, echoing to the
+// default SDL output and appending to the log file with one write per batch.
+// Lines are framed as they will appear in the file before they are queued, so a crash
+// handler can write the ring out with write(2) alone.
+// In binary mode the writer is also the LogSink: log sites and their events are queued as
+// raw records (see LogRecord.hpp) and only text from elsewhere is echoed.
+class LogWriter : public Internal::LogSink
+{
+public:
+    // What a producer does when the ring is full.
+    enum class Overflow
+    {
+        // Discard the line and count it; the count is written to the log later.
+        Drop,
+        // Wait for the writer to make room.
+        Block,
+    };
+
+    LogWriter();
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+    ~LogWriter() override;
+
+    // Start the writer thread. Returns false if the file cannot be opened, in which case
+    // lines still go to the default SDL output.
+    bool Start(const std::string& path, Overflow overflow, bool binary);
+    // Write out everything queued so far and stop the writer thread.
+    void Stop();
+    void Write(int category, SDL_LogPriority priority, const char* message);
+    uint64_t GetDropped() const;
+
+    uint32_t RegisterSite(LogLevel level, LogCategory category, std::string_view file, uint32_t line,
+                          std::string_view format, std::string_view types) override;
+    void WriteEvent(uint32_t site, const char* arguments, uint32_t size) override;
+
+    // Suitable for SDL_SetLogOutputFunction, with the LogWriter as userdata.
+    static void SDLCALL Output(void* userdata, int category, SDL_LogPriority priority, const char* message);
+    // Write out whatever is queued if the process crashes or calls std::terminate.
+    void FlushOnCrash();
+
+private:
+    static constexpr uint32_t Capacity = 8192;
+    static constexpr uint32_t SlotText = 240;
+    // Longer lines are truncated rather than allowed to take over the ring.
+    static constexpr uint32_t MaxSlotsPerLine = 16;
+    static constexpr uint32_t LineMax = MaxSlotsPerLine * SlotText;
+    // Type, level and length of a Text record in binary mode.
+    static constexpr uint32_t TextHeader = 2 + sizeof(uint32_t);
+
+    // A line takes one or more consecutive slots; all but the last have more set. Slots hold
+    // the bytes that go to the file: records as encoded, text lines framed by FrameText.
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        int category;
+        SDL_LogPriority priority;
+        uint16_t length;
+        bool more;
+        bool record;
+        char text[SlotText];
+    };
+
+    // Queue a line or record. Records must never be cut short or dropped, as the rest of
+    // the file would no longer decode.
+    void Enqueue(const char* data, uint32_t length, int category, SDL_LogPriority priority, bool record);
+    void Run();
+    // Move every published line into m_batch and write it out. Only one thread may drain
+    // at a time; m_draining guards that between the writer and a crash handler.
+    bool Drain();
+    // Frame a text line as it goes to the file, with a newline or as a Text record in binary
+    // mode, truncated to LineMax. Returns the framed length.
+    uint32_t FrameText(const char* message, size_t length, SDL_LogPriority priority, char* out) const;
+    void Flush();
+    // Write every complete line left in the ring straight to the file with write(2). Safe in
+    // a signal handler: it neither allocates nor takes a lock.
+    void WriteOutOnCrash();
+    static void CrashHandler(int signal);
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_tail;
+    uint64_t m_head;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic_flag m_draining;
+    Overflow m_overflow;
+    bool m_binary;
+    std::atomic<uint32_t> m_sites;
+    std::chrono::steady_clock::time_point m_start;
+
+    std::FILE* m_file;
+    // m_file's descriptor, for the crash handler.
+    int m_fd;
+    std::string m_batch;
+    std::string m_line;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_sleeping;
+    std::atomic<bool> m_stop;
+};
+
+}
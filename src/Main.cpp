@@ -3,39 +3,58 @@
 #include <SDL3/SDL_main.h>
 
 #include <string>
-#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
 
 #include "Api.hpp"
 #include "App.hpp"
+#include "Engine.hpp"
+#include "Headless.hpp"
+#include "LogWriter.hpp"
+#include "MatchSpec.hpp"
+#include "ModuleRegistry.hpp"
+#include "Tournament.hpp"
+#include "Trace.hpp"
 
 // Verbose logging.
 static bool verbose = false;
+static std::string logLevels;
 static bool debug = false;
 // Damage enabled?
 static bool damage = true;
 static bool pause_on_scan = false;
+static bool headless = false;
+static bool bruteForceScan = false;
+static uint64_t maxTicks = 0;
+static uint32_t matches = 1;
+static std::vector<std::string> matchRobots;
+static std::string matchFile;
+static std::vector<std::string> tournamentRobots;
+static uint32_t rounds = 1;
+static uint32_t threads = 0;
+static uint32_t robotThreads = 1;
+static uint64_t tickBudgetUs = 0;
+static uint64_t matchBudgetMs = 0;
+static std::string budgetPolicy{"warn"};
+static uint32_t budgetSkip = 10;
+static bool sandbox = false;
+static uint32_t sandboxDeadlineMs = 250;
+static std::string replay;
+static std::string profileOut;
+static std::string traceOut;
+static uint64_t seed = 0;
+static std::string robotDir{"."};
+static bool listRobots = false;
 
 static uint32_t arenaX = 100;
 static uint32_t arenaY = 100;
 // FIXME: make logpath configurable
 static std::string logFile{"crobots++.log"};
-static std::ofstream logStream;
-
-/* TODO(Michael): We should have enums "Robot1", "Robot2", etc, etc and an array */
-static std::string robot1_path;
-static std::string robot2_path;
-static std::string robot3_path;
-static std::string robot4_path;
-
-static void LogCallback(void* data, int category, SDL_LogPriority priority, const char* string)
-{
-    SDL_GetDefaultLogOutputFunction()(data, category, priority, string);
-    if (logStream.is_open())
-    {
-        logStream << string << '\n';
-        logStream.flush();
-    }
-}
+static bool dropLogOnOverflow = false;
+static bool binaryLog = false;
+static Crobots::LogWriter logWriter;
 
 // https://github.com/CLIUtils/CLI11 for CLI
 static bool ParseOptions(int argc, char** argv, Crobots::AppInfo& info)
@@ -46,16 +65,40 @@ static bool ParseOptions(int argc, char** argv, Crobots::AppInfo& info)
     argv = parser.ensure_utf8(argv);
 
     parser.add_flag("-v,--verbose", verbose, "Verbose logging");
+    parser.add_option("--log", logLevels, "Log levels, eg. engine=debug,scan=off (trace, debug, info, warn, error, off)");
     parser.add_flag("-d,--debug", debug, "Enable debug features");
     parser.add_flag("-p,--pause-on-scan", pause_on_scan, "Pause on each scan hit");
     parser.add_flag("!-D,!--no-damage", damage, "Disable damage for debugging");
-    parser.add_option("-x,--arena-x", arenaX, "Arena X dimension (default 1000)")->check(CLI::Number);
-    parser.add_option("-y,--arena-y", arenaY, "Arena Y dimension (default 1000)")->check(CLI::Number);
+    CLI::Option* arenaXOption = parser.add_option("-x,--arena-x", arenaX, "Arena X dimension (default 1000)")->check(CLI::Range(1u, Crobots::MatchSpec::MaxArena));
+    CLI::Option* arenaYOption = parser.add_option("-y,--arena-y", arenaY, "Arena Y dimension (default 1000)")->check(CLI::Range(1u, Crobots::MatchSpec::MaxArena));
     parser.add_option("-l,--logfile", logFile, "Path to logfile (default crobots++.log)");
-	parser.add_option("robot1", robot1_path, "First robot")->required();
-	parser.add_option("robot2", robot2_path, "Second robot");
-	parser.add_option("robot3", robot3_path, "Third robot");
-	parser.add_option("robot4", robot4_path, "Fourth robot");
+    parser.add_flag("--log-binary", binaryLog, "Write a binary log, read it with crobots_logdecode");
+    parser.add_flag("--log-drop", dropLogOnOverflow, "Drop log lines instead of waiting when the log writer falls behind");
+    parser.add_flag("--headless", headless, "Run without rendering and print the result as JSON");
+    parser.add_flag("--brute-force-scan", bruteForceScan, "Test every robot on each scan instead of using the spatial grid");
+    CLI::Option* seedOption = parser.add_option("-s,--seed", seed, "Random seed, for reproducible matches (default random)");
+    parser.add_option("--replay", replay, "Record the match to this file (a directory for tournaments)");
+    parser.add_option("--profile-out", profileOut, "Write per-phase and per-robot tick timings and counters as JSON to this file at match end");
+    parser.add_option("--trace-out", traceOut, "Record a timeline of engine ticks, robot ticks and frames to this file (Chrome trace JSON, open in Perfetto)");
+    parser.add_option("--robot-threads", robotThreads, "Threads ticking the robots of a match (default 1, 0 for one per core)")->check(CLI::Number);
+    parser.add_option("--tick-budget-us", tickBudgetUs, "CPU time a robot may spend in one Tick (default 0, no limit)")->check(CLI::Number);
+    parser.add_option("--match-budget-ms", matchBudgetMs, "CPU time a robot may spend in Tick over a match (default 0, no limit)")->check(CLI::Number);
+    parser.add_option("--budget-policy", budgetPolicy, "What to do with a robot over budget: warn (default), skip or disqualify");
+    parser.add_option("--budget-skip", budgetSkip, "Ticks a robot sits out for going over its tick budget with --budget-policy skip (default 10)")->check(CLI::Number);
+    parser.add_flag("--sandbox", sandbox, "Run each robot in a child process of its own (Linux only)");
+    parser.add_option("--sandbox-deadline-ms", sandboxDeadlineMs, "Time a sandboxed robot has to answer a tick before it is out of the match (default 250)")->check(CLI::Number);
+    parser.add_option("--robot-dir", robotDir, "Directory the robot modules are loaded from (default .)");
+    parser.add_flag("--list-robots", listRobots, "List the robots in the robot directory and exit");
+    CLI::Option* maxTicksOption = parser.add_option("-t,--ticks,--max-ticks", maxTicks, "Stop after this many ticks (default 0, no limit)")->check(CLI::Number);
+    parser.add_option("--matches", matches, "Headless matches to run back to back in one engine, the seed counting up by one (default 1)")->check(CLI::PositiveNumber);
+    parser.add_option("--match", matchFile, "JSON match spec with the arena, seed, tick limit and any number of robots");
+    parser.add_option("robots", matchRobots, "Robots in the match");
+
+    CLI::App* tournament = parser.add_subcommand("tournament", "Run a headless round-robin tournament");
+    tournament->fallthrough();
+    tournament->add_option("robots", tournamentRobots, "Robots taking part")->required();
+    tournament->add_option("-r,--rounds", rounds, "Matches per pairing (default 1)")->check(CLI::Number);
+    tournament->add_option("-j,--threads", threads, "Worker threads (default 0, one per core)")->check(CLI::Number);
 
     try
     {
@@ -66,61 +109,200 @@ static bool ParseOptions(int argc, char** argv, Crobots::AppInfo& info)
         parser.exit(e);
         return false;
     }
+    Crobots::ModuleRegistry::Get().SetDirectory(robotDir);
+    bool seeded = seedOption->count() > 0;
+    // Options given on the command line win over the match spec.
+    if (!matchFile.empty())
+    {
+        Crobots::MatchSpec spec;
+        if (!spec.Load(matchFile))
+        {
+            return false;
+        }
+        if (spec.arenaX && arenaXOption->count() == 0)
+        {
+            arenaX = *spec.arenaX;
+        }
+        if (spec.arenaY && arenaYOption->count() == 0)
+        {
+            arenaY = *spec.arenaY;
+        }
+        if (spec.maxTicks && maxTicksOption->count() == 0)
+        {
+            maxTicks = *spec.maxTicks;
+        }
+        if (spec.seed && !seeded)
+        {
+            seed = *spec.seed;
+            seeded = true;
+        }
+        matchRobots.insert(matchRobots.end(), spec.robots.begin(), spec.robots.end());
+    }
+    if (!tournament->parsed() && !listRobots && matchRobots.empty())
+    {
+        parser.exit(CLI::RequiredError("robots"));
+        return false;
+    }
+    if (verbose)
+    {
+        Crobots::Internal::SetLogLevels("trace");
+    }
+    if (!Crobots::Internal::SetLogLevels(logLevels))
+    {
+        std::cerr << "--log: invalid log levels: " << logLevels << std::endl;
+        return false;
+    }
 
     info.arenaX = arenaX;
     info.arenaY = arenaY;
-	info.nrobots = 0;
-	info.robot1_path = "";
-	info.robot2_path = "";
-	info.robot3_path = "";
-	info.robot4_path = "";
     info.debug = debug;
     info.damage = damage;
     info.pause_on_scan = pause_on_scan;
     info.verbose = verbose;
-	if (! robot1_path.empty())
-	{
-		info.nrobots++;
-        info.robot1_path = robot1_path;
-	}
-	if (! robot2_path.empty())
-	{
-		info.nrobots++;
-        info.robot2_path = robot2_path;
-	}
-	if (! robot3_path.empty())
-	{
-		info.nrobots++;
-        info.robot3_path = robot3_path;
-	}
-	if (! robot4_path.empty())
-	{
-		info.nrobots++;
-        info.robot4_path = robot4_path;
-	}
+    info.headless = headless;
+    info.bruteForceScan = bruteForceScan;
+    info.maxTicks = maxTicks;
+    info.matches = matches;
+    info.tournament = tournament->parsed();
+    info.robots = info.tournament ? tournamentRobots : matchRobots;
+    info.rounds = rounds;
+    info.threads = threads;
+    info.robotThreads = robotThreads;
+    info.cpuBudget.tickNs = tickBudgetUs * 1000;
+    info.cpuBudget.matchNs = matchBudgetMs * 1000000;
+    const std::map<std::string, Crobots::BudgetPolicy> policies{
+        {"warn", Crobots::BudgetPolicy::Warn},
+        {"skip", Crobots::BudgetPolicy::Skip},
+        {"disqualify", Crobots::BudgetPolicy::Disqualify},
+    };
+    auto policy = policies.find(budgetPolicy);
+    if (policy == policies.end())
+    {
+        std::cerr << "--budget-policy: expected warn, skip or disqualify, got " << budgetPolicy << std::endl;
+        return false;
+    }
+    info.cpuBudget.policy = policy->second;
+    info.cpuBudget.skipTicks = budgetSkip;
+    info.sandbox.enabled = sandbox;
+    info.sandbox.deadlineNs = static_cast<uint64_t>(sandboxDeadlineMs) * 1000000;
+    info.replay = replay;
+    info.profileOut = profileOut;
+    if (info.tournament && !profileOut.empty())
+    {
+        std::cerr << "--profile-out profiles a single match, not a tournament" << std::endl;
+        return false;
+    }
+    if (matches > 1 && (!headless || info.tournament))
+    {
+        std::cerr << "--matches runs headless matches, add --headless" << std::endl;
+        return false;
+    }
+    if (matches > 1 && (!replay.empty() || !profileOut.empty()))
+    {
+        std::cerr << "--replay and --profile-out record a single match, not --matches" << std::endl;
+        return false;
+    }
+    if (!seeded)
+    {
+        std::random_device device;
+        seed = (static_cast<uint64_t>(device()) << 32) | device();
+    }
+    info.seed = seed;
 
     return true;
 }
 
+static void StartTrace()
+{
+    if (!traceOut.empty())
+    {
+        Crobots::TraceRecorder::Get().Start();
+    }
+}
+
+// Only once every thread that records has stopped.
+static void WriteTrace()
+{
+    if (!traceOut.empty())
+    {
+        Crobots::TraceRecorder& recorder = Crobots::TraceRecorder::Get();
+        recorder.Stop();
+        if (recorder.Write(traceOut))
+        {
+            CROBOTS_LOG_INFO(Engine, "wrote {} trace events to {}", recorder.GetEventCount(), traceOut);
+        }
+    }
+}
+
 /* TODO: switch to callbacks when resize slowdowns on Vulkan get fixed */
 int main(int argc, char** argv)
 {
+    Crobots::TraceRecorder::SetThreadName("main");
     Crobots::AppInfo info{};
     info.title = "Crobots++";
     if (!ParseOptions(argc, argv, info))
     {
         return 1;
     }
+    if (listRobots)
+    {
+        for (const std::string& robot : Crobots::ModuleRegistry::Get().Preload())
+        {
+            std::cout << robot << std::endl;
+        }
+        Crobots::ModuleRegistry::Get().Release();
+        return 0;
+    }
     SDL_SetLogPriorities(SDL_LOG_PRIORITY_VERBOSE);
-    logStream.open(logFile, std::ios::out);
-    if (!logStream.is_open())
+    // Sandboxes are forked by a helper that must start before any thread does, the log
+    // writer's included.
+    if (sandbox && !Crobots::Engine::StartSandboxHelper())
+    {
+        std::cerr << "--sandbox: cannot start the sandbox helper, robots run in process" << std::endl;
+    }
+    bool logOpened = logWriter.Start(logFile,
+        dropLogOnOverflow ? Crobots::LogWriter::Overflow::Drop : Crobots::LogWriter::Overflow::Block, binaryLog);
+    logWriter.FlushOnCrash();
+    if (binaryLog)
     {
-        CROBOTS_LOG("Failed to open log stream: %s", SDL_GetError());
+        Crobots::Internal::SetLogSink(&logWriter);
+    }
+    SDL_SetLogOutputFunction(&Crobots::LogWriter::Output, &logWriter);
+    if (!logOpened)
+    {
+        CROBOTS_LOG_WARN(Engine, "Failed to open log file {}", logFile);
+    }
+    StartTrace();
+    if (info.tournament || info.headless)
+    {
+        int result = 1;
+        if (info.tournament)
+        {
+            Crobots::Tournament tournament{};
+            if (tournament.Init(info))
+            {
+                result = tournament.Run();
+            }
+        }
+        else
+        {
+            Crobots::Headless headless{};
+            if (headless.Init(info))
+            {
+                result = headless.Run();
+            }
+        }
+        WriteTrace();
+        SDL_ResetLogPriorities();
+        SDL_SetLogOutputFunction(SDL_GetDefaultLogOutputFunction(), nullptr);
+        Crobots::Internal::SetLogSink(nullptr);
+        logWriter.Stop();
+        return result;
     }
-    SDL_SetLogOutputFunction(LogCallback, nullptr);
     Crobots::App app{};
     if (!app.Init(info))
     {
+        WriteTrace();
         return 1;
     }
     while (!app.ShouldQuit())
@@ -133,8 +315,10 @@ int main(int argc, char** argv)
         app.Iterate();
     }
     app.Quit();
+    WriteTrace();
     SDL_ResetLogPriorities();
     SDL_SetLogOutputFunction(SDL_GetDefaultLogOutputFunction(), nullptr);
-    logStream.close();
+    Crobots::Internal::SetLogSink(nullptr);
+    logWriter.Stop();
     return 0;
 }
@@ -0,0 +1,65 @@
+#include <fstream>
+#include <iostream>
+
+#include "json.hpp"
+
+#include "MatchSpec.hpp"
+
+namespace Crobots
+{
+
+bool MatchSpec::Load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Cannot open match spec " << path << std::endl;
+        return false;
+    }
+    try
+    {
+        nlohmann::json spec = nlohmann::json::parse(file);
+        if (spec.contains("arena"))
+        {
+            arenaX = spec["arena"].at("x").get<uint32_t>();
+            arenaY = spec["arena"].at("y").get<uint32_t>();
+            if (*arenaX == 0 || *arenaY == 0 || *arenaX > MaxArena || *arenaY > MaxArena)
+            {
+                std::cerr << "Invalid match spec " << path << ": arena sides must be 1 - " << MaxArena << std::endl;
+                return false;
+            }
+        }
+        if (spec.contains("seed"))
+        {
+            seed = spec["seed"].get<uint64_t>();
+        }
+        if (spec.contains("max_ticks"))
+        {
+            maxTicks = spec["max_ticks"].get<uint64_t>();
+        }
+        for (const nlohmann::json& robot : spec.at("robots"))
+        {
+            std::string name = robot.is_string() ? robot.get<std::string>() : robot.at("name").get<std::string>();
+            uint64_t count = robot.is_object() ? robot.value("count", uint64_t{1}) : 1;
+            if (count > MaxRobots - robots.size())
+            {
+                std::cerr << "Match spec " << path << " has more than " << MaxRobots << " robots" << std::endl;
+                return false;
+            }
+            robots.insert(robots.end(), count, name);
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        std::cerr << "Invalid match spec " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    if (robots.empty())
+    {
+        std::cerr << "Match spec " << path << " has no robots" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
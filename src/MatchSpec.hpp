@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Crobots
+{
+
+/*
+    A match described in a JSON file, for matches with more robots than fit on a command
+    line. Everything but the robots is optional:
+
+        {
+            "arena": {"x": 1000, "y": 1000},
+            "seed": 42,
+            "max_ticks": 10000,
+            "robots": [
+                {"name": "Dummy", "count": 255},
+                "Classics:Rook"
+            ]
+        }
+
+    A robot is a name, or an object with a name and a count of copies (default 1).
+*/
+struct MatchSpec
+{
+    static constexpr uint32_t MaxRobots = 100000;
+    // Largest arena side, so positions keep sub-metre precision as floats.
+    static constexpr uint32_t MaxArena = 1000000;
+
+    std::optional<uint32_t> arenaX;
+    std::optional<uint32_t> arenaY;
+    std::optional<uint64_t> seed;
+    std::optional<uint64_t> maxTicks;
+    // One entry per robot, copies included, in the order they are listed.
+    std::vector<std::string> robots;
+
+    // Read the spec at path. On failure prints why to stderr and returns false.
+    bool Load(const std::string& path);
+};
+
+}
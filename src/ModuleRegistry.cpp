@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+#include <SDL3/SDL.h>
+
+#include "Crobots++/Log.hpp"
+#include "ModuleRegistry.hpp"
+#include "TaskPool.hpp"
+
+namespace Crobots
+{
+
+namespace
+{
+
+#if defined(SDL_PLATFORM_WIN32)
+constexpr std::string_view ModulePrefix = "";
+constexpr std::string_view ModuleSuffix = ".dll";
+#elif defined(SDL_PLATFORM_APPLE)
+constexpr std::string_view ModulePrefix = "lib";
+constexpr std::string_view ModuleSuffix = ".dylib";
+#else
+constexpr std::string_view ModulePrefix = "lib";
+constexpr std::string_view ModuleSuffix = ".so";
+#endif
+
+using GetRobotNamesFunc = const char* (*)();
+using GetRobotFactoriesFunc = const GetRobotFunc* (*)();
+
+std::string Trim(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t\n");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    size_t last = text.find_last_not_of(" \t\n");
+    return std::string(text.substr(first, last - first + 1));
+}
+
+}
+
+RobotModule::RobotModule(const std::string& name, const std::string& filename, bool probe)
+: m_name{name}
+, m_object{SDL_LoadObject(filename.c_str())}
+{
+    if (!m_object)
+    {
+        if (probe)
+        {
+            CROBOTS_LOG_DEBUG(Loader, "SDL_LoadObject failed on {}, skipping it", filename);
+        }
+        else
+        {
+            CROBOTS_LOG_ERROR(Loader, "SDL_LoadObject failed on {}", filename);
+        }
+        return;
+    }
+    // A module with several classes names them in one comma separated list, see
+    // CROBOTS_GETROBOTS; otherwise it has a single class, named after the module.
+    auto names = reinterpret_cast<GetRobotNamesFunc>(SDL_LoadFunction(m_object, "GetRobotNames"));
+    auto factories = reinterpret_cast<GetRobotFactoriesFunc>(SDL_LoadFunction(m_object, "GetRobotFactories"));
+    if (names && factories)
+    {
+        std::string_view list = names();
+        const GetRobotFunc* table = factories();
+        for (size_t start = 0; start <= list.size();)
+        {
+            size_t end = std::min(list.find(',', start), list.size());
+            m_classes.push_back(Trim(list.substr(start, end - start)));
+            m_factories.push_back(table[m_factories.size()]);
+            start = end + 1;
+        }
+    }
+    else if (auto fcn = reinterpret_cast<GetRobotFunc>(SDL_LoadFunction(m_object, "GetRobot")))
+    {
+        m_classes.push_back(m_name);
+        m_factories.push_back(fcn);
+    }
+    else
+    {
+        if (probe)
+        {
+            CROBOTS_LOG_DEBUG(Loader, "{} is not a robot module, skipping it", filename);
+        }
+        else
+        {
+            CROBOTS_LOG_ERROR(Loader, "Failed to find entry point in {}", filename);
+        }
+        SDL_UnloadObject(m_object);
+        m_object = nullptr;
+        return;
+    }
+    CROBOTS_LOG_INFO(Loader, "opened robot module {} with {} classes", m_name, m_classes.size());
+}
+
+RobotModule::~RobotModule()
+{
+    if (m_object)
+    {
+        CROBOTS_LOG_INFO(Loader, "closing robot module {}", m_name);
+        SDL_UnloadObject(m_object);
+    }
+}
+
+bool RobotModule::IsOpen() const
+{
+    return !m_factories.empty();
+}
+
+const std::string& RobotModule::GetName() const
+{
+    return m_name;
+}
+
+const std::vector<std::string>& RobotModule::GetClasses() const
+{
+    return m_classes;
+}
+
+GetRobotFunc RobotModule::Find(const std::string& className) const
+{
+    if (className.empty())
+    {
+        return m_factories.empty() ? nullptr : m_factories[0];
+    }
+    auto it = std::find(m_classes.begin(), m_classes.end(), className);
+    return it == m_classes.end() ? nullptr : m_factories[it - m_classes.begin()];
+}
+
+ModuleRegistry::ModuleRegistry()
+: m_directory{"."}
+{}
+
+ModuleRegistry& ModuleRegistry::Get()
+{
+    static ModuleRegistry registry;
+    return registry;
+}
+
+void ModuleRegistry::SetDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory = directory;
+}
+
+RobotFactory ModuleRegistry::Find(const std::string& name)
+{
+    size_t colon = name.find(':');
+    std::string module = name.substr(0, colon);
+    std::string className = colon == std::string::npos ? std::string() : name.substr(colon + 1);
+    // This should not be a path. Reject anything that is.
+    if (module.empty())
+    {
+        CROBOTS_LOG_ERROR(Loader, "Cannot load empty robot name");
+        return {};
+    }
+    if (module.find_first_of("/\\") != std::string::npos || module[0] == '.')
+    {
+        CROBOTS_LOG_ERROR(Loader, "Path characters not permitted in robot name");
+        return {};
+    }
+    std::shared_ptr<RobotModule> opened = Open(module);
+    if (!opened)
+    {
+        return {};
+    }
+    GetRobotFunc create = opened->Find(className);
+    if (!create)
+    {
+        CROBOTS_LOG_ERROR(Loader, "Module {} has no robot {}", module, className);
+        return {};
+    }
+    return {std::move(opened), create};
+}
+
+std::shared_ptr<RobotModule> ModuleRegistry::Open(const std::string& module, bool probe)
+{
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_modules.find(module);
+        if (it != m_modules.end())
+        {
+            if (std::shared_ptr<RobotModule> cached = it->second.lock())
+            {
+                return cached;
+            }
+        }
+        filename = GetFilename(module);
+    }
+    // Opening runs the module's static constructors, so keep it out of the lock. Should two
+    // threads race to open the same module the first one in wins, and the other's reference
+    // is simply dropped again.
+    auto opened = std::make_shared<RobotModule>(module, filename, probe);
+    if (!opened->IsOpen())
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::weak_ptr<RobotModule>& slot = m_modules[module];
+    if (std::shared_ptr<RobotModule> cached = slot.lock())
+    {
+        return cached;
+    }
+    slot = opened;
+    return opened;
+}
+
+std::string ModuleRegistry::GetFilename(const std::string& module) const
+{
+    return (std::filesystem::path(m_directory) / (std::string(ModulePrefix) + module + std::string(ModuleSuffix))).string();
+}
+
+std::vector<std::string> ModuleRegistry::Preload(uint32_t threads)
+{
+    std::vector<std::string> modules;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+        {
+            std::string file = entry.path().filename().string();
+            if (file.size() > ModulePrefix.size() + ModuleSuffix.size() && file.starts_with(ModulePrefix) &&
+                file.ends_with(ModuleSuffix))
+            {
+                modules.push_back(file.substr(ModulePrefix.size(), file.size() - ModulePrefix.size() - ModuleSuffix.size()));
+            }
+        }
+        if (error)
+        {
+            CROBOTS_LOG_ERROR(Loader, "Cannot list robot directory {}: {}", m_directory, error.message());
+        }
+    }
+    std::sort(modules.begin(), modules.end());
+
+    std::vector<std::shared_ptr<RobotModule>> opened(modules.size());
+    {
+        TaskPool pool(threads);
+        for (size_t i = 0; i < modules.size(); i++)
+        {
+            pool.Submit([this, &modules, &opened, i] { opened[i] = Open(modules[i], true); });
+        }
+        pool.Wait();
+    }
+
+    std::vector<std::string> robots;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::shared_ptr<RobotModule>& module : opened)
+    {
+        if (!module)
+        {
+            continue;
+        }
+        for (const std::string& className : module->GetClasses())
+        {
+            robots.push_back(className == module->GetName() ? className : module->GetName() + ":" + className);
+        }
+        m_preloaded.push_back(std::move(module));
+    }
+    CROBOTS_LOG_INFO(Loader, "preloaded {} robot modules from {}", m_preloaded.size(), m_directory);
+    return robots;
+}
+
+void ModuleRegistry::Release()
+{
+    std::vector<std::shared_ptr<RobotModule>> preloaded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        preloaded.swap(m_preloaded);
+    }
+}
+
+bool ModuleRegistry::IsLoaded(const std::string& module)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_modules.find(module);
+    return it != m_modules.end() && !it->second.expired();
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Crobots++/IRobot.hpp>
+
+struct SDL_SharedObject;
+
+namespace Crobots
+{
+
+// An open robot library and the factories of the robot classes it exports. The library is
+// closed when the last reference goes, so anything made from it must hold one.
+class RobotModule
+{
+public:
+    // With probe set the file may well be some other library, so one that does not load
+    // or has no robot entry point is only mentioned at debug level, and closed again.
+    explicit RobotModule(const std::string& name, const std::string& filename, bool probe = false);
+    RobotModule(const RobotModule&) = delete;
+    RobotModule& operator=(const RobotModule&) = delete;
+    ~RobotModule();
+
+    bool IsOpen() const;
+    const std::string& GetName() const;
+    // The robot classes, in the order the module exports them.
+    const std::vector<std::string>& GetClasses() const;
+    // The factory for a class, or the first class when className is empty. nullptr if the
+    // module has no such class.
+    GetRobotFunc Find(const std::string& className) const;
+
+private:
+    std::string m_name;
+    SDL_SharedObject* m_object;
+    std::vector<std::string> m_classes;
+    std::vector<GetRobotFunc> m_factories;
+};
+
+// A robot class ready to be instantiated: its factory and the module that keeps it alive.
+struct RobotFactory
+{
+    std::shared_ptr<RobotModule> module;
+    GetRobotFunc create{nullptr};
+
+    explicit operator bool() const { return create != nullptr; }
+};
+
+/*
+    Process-wide cache of robot modules. A robot is named "Module" or "Module:Class" and its
+    module is looked up in the robot directory by the platform's naming convention, so Dummy
+    is ./libDummy.so on Linux. Each module is opened once and stays open for as long as a
+    factory or robot made from it is alive; after that the next Find opens it again.
+*/
+class ModuleRegistry
+{
+public:
+    static ModuleRegistry& Get();
+
+    void SetDirectory(const std::string& directory);
+    // An empty factory if the name is not valid or the module or class does not exist.
+    RobotFactory Find(const std::string& name);
+    // Open every module in the robot directory, on up to threads threads (0 for one per
+    // hardware thread), and keep them open until Release. Returns the robots found. Other
+    // libraries in the directory, like SDL next to the program, are skipped quietly.
+    std::vector<std::string> Preload(uint32_t threads = 0);
+    void Release();
+    bool IsLoaded(const std::string& module);
+
+private:
+    ModuleRegistry();
+
+    std::shared_ptr<RobotModule> Open(const std::string& module, bool probe = false);
+    std::string GetFilename(const std::string& module) const;
+
+    std::mutex m_mutex;
+    std::string m_directory;
+    std::unordered_map<std::string, std::weak_ptr<RobotModule>> m_modules;
+    std::vector<std::shared_ptr<RobotModule>> m_preloaded;
+};
+
+}
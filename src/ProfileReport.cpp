@@ -0,0 +1,89 @@
+#include <fstream>
+
+#include "ProfileReport.hpp"
+
+namespace Crobots
+{
+
+namespace
+{
+
+nlohmann::json HistogramJson(const CostHistogram& histogram, double nsPerCycle)
+{
+    auto ns = [nsPerCycle](double cycles) { return static_cast<uint64_t>(cycles * nsPerCycle + 0.5); };
+    nlohmann::json result;
+    result["count"] = histogram.GetCount();
+    result["mean_ns"] = histogram.GetCount() > 0 ? ns(static_cast<double>(histogram.GetTotal()) / histogram.GetCount()) : 0;
+    result["p50_ns"] = ns(histogram.GetPercentile(0.5));
+    result["p90_ns"] = ns(histogram.GetPercentile(0.9));
+    result["p99_ns"] = ns(histogram.GetPercentile(0.99));
+    result["p999_ns"] = ns(histogram.GetPercentile(0.999));
+    result["max_ns"] = ns(histogram.GetMax());
+    result["total_ns"] = ns(histogram.GetTotal());
+    return result;
+}
+
+}
+
+nlohmann::json ProfileJson(const Profiler& profiler, const Engine& engine)
+{
+    double nsPerCycle = profiler.GetNanosecondsPerCycle();
+    nlohmann::json result;
+    result["seed"] = engine.GetSeed();
+    result["ticks"] = engine.GetTick();
+    result["ns_per_cycle"] = nsPerCycle;
+
+    nlohmann::json phases;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(Phase::Count); i++)
+    {
+        Phase phase = static_cast<Phase>(i);
+        phases[GetPhaseName(phase)] = HistogramJson(profiler.GetPhase(phase), nsPerCycle);
+    }
+    result["phases"] = phases;
+
+    nlohmann::json robots = nlohmann::json::array();
+    uint64_t scans = 0;
+    uint64_t scanTests = 0;
+    uint64_t contacts = 0;
+    for (uint32_t i = 0; i < profiler.GetRobotCount() && i < engine.GetRobots().size(); i++)
+    {
+        const RobotProfile& robot = profiler.GetRobot(i);
+        nlohmann::json entry;
+        entry["id"] = i;
+        entry["name"] = std::string(engine.GetRobots()[i]->GetName());
+        entry["tick"] = HistogramJson(robot.tick, nsPerCycle);
+        entry["scans"] = robot.scans;
+        entry["scan_tests"] = robot.scanTests;
+        entry["contacts"] = robot.contacts;
+        robots.push_back(entry);
+        scans += robot.scans;
+        scanTests += robot.scanTests;
+        contacts += robot.contacts;
+    }
+    result["robots"] = robots;
+
+    nlohmann::json counters;
+    counters["scans"] = scans;
+    counters["scan_pair_tests"] = scanTests;
+    counters["collision_pair_tests"] = profiler.GetPairTests();
+    counters["collisions"] = profiler.GetCollisions();
+    counters["contacts"] = contacts;
+    counters["shots_alive_mean"] = engine.GetTick() > 0 ? static_cast<double>(profiler.GetShotTicks()) / engine.GetTick() : 0.0;
+    counters["shots_alive_max"] = profiler.GetPeakShots();
+    result["counters"] = counters;
+    return result;
+}
+
+bool WriteProfile(const std::string& path, const Profiler& profiler, const Engine& engine)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Cannot open profile {}", path);
+        return false;
+    }
+    file << ProfileJson(profiler, engine).dump(2) << std::endl;
+    return static_cast<bool>(file);
+}
+
+}
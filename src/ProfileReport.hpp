@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "json.hpp"
+
+#include "Engine.hpp"
+#include "Profiler.hpp"
+
+namespace Crobots
+{
+
+// A profile as JSON, with every duration converted from cycles to nanoseconds.
+nlohmann::json ProfileJson(const Profiler& profiler, const Engine& engine);
+// Write ProfileJson to path. On failure logs why and returns false.
+bool WriteProfile(const std::string& path, const Profiler& profiler, const Engine& engine);
+
+}
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cassert>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#include "Profiler.hpp"
+#include "Trace.hpp"
+
+namespace Crobots
+{
+
+const char* GetPhaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::Robots: return "robots";
+    case Phase::CommitScans: return "commit_scans";
+    case Phase::CommitBudgets: return "commit_budgets";
+    case Phase::CommitSandboxes: return "commit_sandboxes";
+    case Phase::MoveRobots: return "move_robots";
+    case Phase::CollideRobots: return "collide_robots";
+    case Phase::AccelRobots: return "accel_robots";
+    case Phase::AddShots: return "add_shots";
+    case Phase::MoveShots: return "move_shots";
+    case Phase::DetonateShots: return "detonate_shots";
+    case Phase::UpdateArena: return "update_arena";
+    case Phase::Tick: return "tick";
+    case Phase::Count: break;
+    }
+    return "unknown";
+}
+
+uint64_t ReadCycles()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return SteadyNanoseconds();
+#endif
+}
+
+Profiler::Profiler()
+: m_pairTests{0}
+, m_collisions{0}
+, m_shotTicks{0}
+, m_peakShots{0}
+, m_startCycles{ReadCycles()}
+, m_startNs{SteadyNanoseconds()}
+{}
+
+void Profiler::Resize(uint32_t robots)
+{
+    m_robots.resize(robots);
+}
+
+void Profiler::AddPhase(Phase phase, uint64_t cycles)
+{
+    m_phases[static_cast<uint32_t>(phase)].Add(cycles);
+}
+
+RobotProfile& Profiler::GetRobot(uint32_t index)
+{
+    assert( index < m_robots.size() );
+    return m_robots[index];
+}
+
+const RobotProfile& Profiler::GetRobot(uint32_t index) const
+{
+    assert( index < m_robots.size() );
+    return m_robots[index];
+}
+
+uint32_t Profiler::GetRobotCount() const
+{
+    return m_robots.size();
+}
+
+const CostHistogram& Profiler::GetPhase(Phase phase) const
+{
+    return m_phases[static_cast<uint32_t>(phase)];
+}
+
+void Profiler::AddTickCounts(uint32_t pairTests, uint32_t collisions, uint32_t shots)
+{
+    m_pairTests += pairTests;
+    m_collisions += collisions;
+    m_shotTicks += shots;
+    m_peakShots = std::max(m_peakShots, shots);
+}
+
+uint64_t Profiler::GetPairTests() const
+{
+    return m_pairTests;
+}
+
+uint64_t Profiler::GetCollisions() const
+{
+    return m_collisions;
+}
+
+uint64_t Profiler::GetShotTicks() const
+{
+    return m_shotTicks;
+}
+
+uint32_t Profiler::GetPeakShots() const
+{
+    return m_peakShots;
+}
+
+double Profiler::GetNanosecondsPerCycle() const
+{
+    uint64_t cycles = ReadCycles() - m_startCycles;
+    uint64_t ns = SteadyNanoseconds() - m_startNs;
+    return cycles > 0 ? static_cast<double>(ns) / cycles : 1.0;
+}
+
+PhaseClock::PhaseClock(Profiler* profiler)
+: m_profiler{profiler}
+, m_tracing{TraceRecorder::Get().IsRecording()}
+, m_start{profiler || m_tracing ? ReadCycles() : 0}
+, m_last{m_start}
+{}
+
+PhaseClock::~PhaseClock()
+{
+    if (!m_profiler && !m_tracing)
+    {
+        return;
+    }
+    uint64_t now = ReadCycles();
+    if (m_profiler)
+    {
+        m_profiler->AddPhase(Phase::Tick, now - m_start);
+    }
+    if (m_tracing)
+    {
+        TraceRecorder::Get().Complete(GetPhaseName(Phase::Tick), "engine", m_start, now);
+    }
+}
+
+void PhaseClock::Lap(Phase phase)
+{
+    if (!m_profiler && !m_tracing)
+    {
+        return;
+    }
+    uint64_t now = ReadCycles();
+    if (m_profiler)
+    {
+        m_profiler->AddPhase(phase, now - m_last);
+    }
+    if (m_tracing)
+    {
+        TraceRecorder::Get().Complete(GetPhaseName(phase), "engine", m_last, now);
+    }
+    m_last = now;
+}
+
+}
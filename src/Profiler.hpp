@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "CpuBudget.hpp"
+
+namespace Crobots
+{
+
+// The phases of Engine::Tick, in the order they run, and the whole tick.
+enum class Phase : uint32_t
+{
+    Robots,
+    CommitScans,
+    CommitBudgets,
+    CommitSandboxes,
+    MoveRobots,
+    CollideRobots,
+    AccelRobots,
+    AddShots,
+    MoveShots,
+    DetonateShots,
+    UpdateArena,
+    Tick,
+    Count,
+};
+
+const char* GetPhaseName(Phase phase);
+
+// A cheap, monotonic cycle counter: the TSC on x86-64, the virtual counter on AArch64 and
+// steady clock nanoseconds elsewhere. Profiler::GetNanosecondsPerCycle converts.
+uint64_t ReadCycles();
+
+// What one robot did over the match. Only touched by the robot's own Tick, so robots can
+// tick in parallel.
+struct RobotProfile
+{
+    // Cycles per Tick.
+    CostHistogram tick;
+    uint64_t scans{0};
+    // Robots tested against the robot's scans.
+    uint64_t scanTests{0};
+    uint64_t contacts{0};
+};
+
+/*
+    Where an engine's tick time goes: a latency histogram per phase and per robot, kept in
+    cycles, and counters for the work done. Attach one with Engine::SetProfiler; without
+    one the engine skips every measurement.
+*/
+class Profiler
+{
+public:
+    Profiler();
+
+    void Resize(uint32_t robots);
+    void AddPhase(Phase phase, uint64_t cycles);
+    RobotProfile& GetRobot(uint32_t index);
+    const RobotProfile& GetRobot(uint32_t index) const;
+    uint32_t GetRobotCount() const;
+    const CostHistogram& GetPhase(Phase phase) const;
+    // Once per tick: circle tests and overlaps found by the collision check, and the shots
+    // in flight at the end of the tick.
+    void AddTickCounts(uint32_t pairTests, uint32_t collisions, uint32_t shots);
+    uint64_t GetPairTests() const;
+    uint64_t GetCollisions() const;
+    uint64_t GetShotTicks() const;
+    uint32_t GetPeakShots() const;
+    // Measured against the steady clock from construction to now, so the longer the
+    // profile runs the more exact it is.
+    double GetNanosecondsPerCycle() const;
+
+private:
+    std::array<CostHistogram, static_cast<uint32_t>(Phase::Count)> m_phases;
+    std::vector<RobotProfile> m_robots;
+    uint64_t m_pairTests;
+    uint64_t m_collisions;
+    uint64_t m_shotTicks;
+    uint32_t m_peakShots;
+    uint64_t m_startCycles;
+    uint64_t m_startNs;
+};
+
+// Times the phases of one tick, one cycle counter read per phase. Lap records the time
+// since the last lap against a phase, and the whole tick is recorded on destruction. Each
+// goes to the profiler, if there is one, and to the trace, if it is recording.
+class PhaseClock
+{
+public:
+    explicit PhaseClock(Profiler* profiler);
+    ~PhaseClock();
+    PhaseClock(const PhaseClock&) = delete;
+    PhaseClock& operator=(const PhaseClock&) = delete;
+
+    void Lap(Phase phase);
+
+private:
+    Profiler* m_profiler;
+    bool m_tracing;
+    uint64_t m_start;
+    uint64_t m_last;
+};
+
+}
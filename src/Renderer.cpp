@@ -16,7 +16,8 @@
 #include "Camera.hpp"
 #include "Engine.hpp"
 #include "Renderer.hpp"
-#include "Shot.hpp"
+#include "Snapshot.hpp"
+#include "Trace.hpp"
 
 namespace
 {
@@ -24,6 +25,18 @@ namespace
 static constexpr int GridSpacing = 5;
 static constexpr const char* FontPath = "RasterForgeRegular.ttf";
 
+void TraceGpu(void* userdata, const char* name, bool begin)
+{
+    if (begin)
+    {
+        Crobots::TraceRecorder::Get().Begin(name, "gpu");
+    }
+    else
+    {
+        Crobots::TraceRecorder::Get().End(name, "gpu");
+    }
+}
+
 }
 
 namespace Crobots
@@ -33,32 +46,33 @@ bool Renderer::Init()
 {
     if (!SDL_Init(SDL_INIT_VIDEO))
     {
-        CROBOTS_LOG("Failed to initialize SDL: %s", SDL_GetError());
+        CROBOTS_LOG_ERROR(Render, "Failed to initialize SDL: %s", SDL_GetError());
         return false;
     }
     m_window = SDL_CreateWindow("Crobots++", 960, 720, SDL_WINDOW_RESIZABLE);
     if (!m_window)
     {
-        CROBOTS_LOG("Failed to create window: %s", SDL_GetError());
+        CROBOTS_LOG_ERROR(Render, "Failed to create window: %s", SDL_GetError());
         return false;
     }
     m_device = SDLx_GPUCreateDevice(true);
     if (!m_device)
     {
-        CROBOTS_LOG("Failed to create device: %s", SDL_GetError());;
+        CROBOTS_LOG_ERROR(Render, "Failed to create device: %s", SDL_GetError());;
         return false;
     }
     if (!SDL_ClaimWindowForGPUDevice(m_device, m_window))
     {
-        CROBOTS_LOG("Failed to claim window: %s", SDL_GetError());
+        CROBOTS_LOG_ERROR(Render, "Failed to claim window: %s", SDL_GetError());
         return false;
     }
     m_renderer = SDLx_GPUCreateRenderer(m_device);
     if (!m_renderer)
     {
-        CROBOTS_LOG("Failed to create renderer: %s", SDL_GetError());
+        CROBOTS_LOG_ERROR(Render, "Failed to create renderer: %s", SDL_GetError());
         return false;
     }
+    SDLx_GPUSetTraceFunction(&TraceGpu, nullptr);
     SDL_FlashWindow(m_window, SDL_FLASH_BRIEFLY);
     return true;
 }
@@ -72,8 +86,9 @@ void Renderer::Quit()
     SDL_DestroyGPUDevice(m_device);
 }
 
-void Renderer::Present(const std::shared_ptr<Engine> engine, Camera& camera)
+void Renderer::Present(const Snapshot& snapshot, Camera& camera)
 {
+    TraceScope trace("present", "render");
     SDL_GPUCommandBuffer* commandBuffer;
     SDL_GPUTexture* swapchainTexture;
     uint32_t width;
@@ -95,7 +110,7 @@ void Renderer::Present(const std::shared_ptr<Engine> engine, Camera& camera)
             return;
         }
     }
-    const Arena& arena = engine->GetArena();
+    Arena arena(snapshot.arenaX, snapshot.arenaY);
     camera.SetCenter(arena.GetX() / 2, arena.GetY() / 2);
     camera.SetViewport(width, height);
     camera.Update();
@@ -121,54 +136,51 @@ void Renderer::Present(const std::shared_ptr<Engine> engine, Camera& camera)
             float b = j * GridSpacing;
             Draw(std::format("{} {}", i * GridSpacing, j * GridSpacing), arena.GetX() - a, b, 0xFFFFFFFF);
         }
-        auto& robots = engine->GetRobots();
-        for (auto& robot : robots)
+        for (const SnapshotRobot& robot : snapshot.robots)
         {
-            Draw("default", arena.GetX() - robot->GetX(), 0.0f, robot->GetY(), IRobot::ToRadians(robot->GetFacing()), 0.1f);
+            Draw("default", arena.GetX() - robot.x, 0.0f, robot.y, IRobot::ToRadians(robot.facing), 0.1f);
             // Draw debug lines if debug is enabled.
-            if (engine->DebugEnabled())
+            if (snapshot.debug)
             {
                 // The facing line
-                Position facing = Engine::GetPositionAhead(robot->GetX(), robot->GetY(), robot->GetFacing(), 50.0f);
-                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot->GetX(), 0.0f, robot->GetY(),
+                Position facing = Engine::GetPositionAhead(robot.x, robot.y, robot.facing, 50.0f);
+                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot.x, 0.0f, robot.y,
                     arena.GetX() - facing.GetX(), 0.0f, facing.GetY(),
                     0xFF00FFFF);
                 // The center scan line
-                Position scandir = Engine::GetPositionAhead(robot->GetX(), robot->GetY(), robot->GetScanDir(), 60.0f);
-                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot->GetX(), 0.0f, robot->GetY(),
+                Position scandir = Engine::GetPositionAhead(robot.x, robot.y, robot.scanDir, 60.0f);
+                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot.x, 0.0f, robot.y,
                     arena.GetX() - scandir.GetX(), 0.0f, scandir.GetY(),
                     0x00FFFFFF);
-                float resolution = robot->GetResolution();
+                float resolution = robot.resolution;
                 // The right boundary of the scan
-                Position scanright = Engine::GetPositionAhead(robot->GetX(),
-                                                              robot->GetY(),
-                                                              robot->GetScanDir()+(resolution/2),
+                Position scanright = Engine::GetPositionAhead(robot.x,
+                                                              robot.y,
+                                                              robot.scanDir+(resolution/2),
                                                               60.0f);
-                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot->GetX(), 0.0f, robot->GetY(),
+                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot.x, 0.0f, robot.y,
                     arena.GetX() - scanright.GetX(), 0.0f, scanright.GetY(),
                     0x00FFFFFF);
                 // The left boundary of the scan
-                Position scanleft = Engine::GetPositionAhead(robot->GetX(),
-                                                             robot->GetY(),
-                                                             robot->GetScanDir()-(resolution/2),
+                Position scanleft = Engine::GetPositionAhead(robot.x,
+                                                             robot.y,
+                                                             robot.scanDir-(resolution/2),
                                                              60.0f);
-                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot->GetX(), 0.0f, robot->GetY(),
+                SDLx_GPURenderLine3D(m_renderer, arena.GetX() - robot.x, 0.0f, robot.y,
                     arena.GetX() - scanleft.GetX(), 0.0f, scanleft.GetY(),
                     0x00FFFFFF);
-                const std::vector<std::unique_ptr<ContactDetails>>& contacts = robot->GetContacts();
-                for (const std::unique_ptr<ContactDetails>& contact : contacts) {
-                    CROBOTS_LOG("contact at bearing {}, range {}", contact->m_bearing, contact->m_range);
-                    CROBOTS_LOG("from {} {} to {} {}", contact->m_fromx, contact->m_fromy,
-                                                       contact->m_tox, contact->m_toy);
-                    SDLx_GPURenderLine3D(m_renderer, arena.GetX() - contact->m_fromx, 0.0f, contact->m_fromy,
-                        arena.GetX() - contact->m_tox, 0.0f, contact->m_toy,
+                for (uint32_t i = 0; i < robot.contactCount; i++) {
+                    const SnapshotContact& contact = snapshot.contacts[robot.firstContact + i];
+                    CROBOTS_LOG_TRACE(Render, "from {} {} to {} {}", contact.fromX, contact.fromY,
+                                                       contact.toX, contact.toY);
+                    SDLx_GPURenderLine3D(m_renderer, arena.GetX() - contact.fromX, 0.0f, contact.fromY,
+                        arena.GetX() - contact.toX, 0.0f, contact.toY,
                         0x00FFFFFF);
                 }
             }
         }
-        auto& shots = engine->GetShots();
-        for (auto& shot : shots) {
-            Draw("default", arena.GetX() - shot.GetX(), 0.0f, shot.GetY(), IRobot::ToRadians(shot.GetFacing()), 0.1f);
+        for (const SnapshotShot& shot : snapshot.shots) {
+            Draw("default", arena.GetX() - shot.x, 0.0f, shot.y, IRobot::ToRadians(shot.facing), 0.1f);
         }
     }
     SDLx_GPUClear(commandBuffer, m_colorTexture, m_depthTexture);
@@ -12,14 +12,15 @@ namespace Crobots
 {
 
 class Camera;
-class Engine;
+struct Snapshot;
 
 class Renderer
 {
 public:
     bool Init();
     void Quit();
-    void Present(const std::shared_ptr<Engine> engine, Camera& canera);
+    // Draw a frame from a snapshot; the live engine is never read while rendering.
+    void Present(const Snapshot& snapshot, Camera& camera);
 
     /**
      * @param path The name of the robot model
@@ -0,0 +1,556 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Engine.hpp"
+#include "Replay.hpp"
+
+namespace
+{
+
+// Buffered output is written once it grows past this.
+static constexpr size_t FlushSize = 1 << 16;
+static constexpr size_t FooterSize = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(Crobots::ReplayMagic);
+
+}
+
+namespace Crobots
+{
+
+int32_t ReplayQuantize(float value, float scale)
+{
+    double scaled = static_cast<double>(value) * scale;
+    if (!std::isfinite(scaled))
+    {
+        return 0;
+    }
+    scaled = std::clamp<double>(scaled, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+    return static_cast<int32_t>(std::lround(scaled));
+}
+
+ReplayRecorder::ReplayRecorder()
+    : m_file{nullptr}
+    , m_offset{0}
+    , m_interval{0}
+    , m_lastTick{0}
+{}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    Finish();
+}
+
+bool ReplayRecorder::Start(const std::string& path, const Engine& engine, uint32_t keyframeInterval)
+{
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file)
+    {
+        return false;
+    }
+    m_interval = std::max(1u, keyframeInterval);
+    m_offset = 0;
+    m_keyframes.clear();
+    m_buffer.clear();
+    m_buffer.insert(m_buffer.end(), std::begin(ReplayMagic), std::end(ReplayMagic));
+    Put(engine.GetArena().GetX());
+    Put(engine.GetArena().GetY());
+    Put(engine.GetSeed());
+    Put(m_interval);
+    Put(static_cast<uint32_t>(engine.GetRobots().size()));
+    for (const std::shared_ptr<IRobot>& robot : engine.GetRobots())
+    {
+        std::string_view name = robot->GetName();
+        uint16_t length = std::min<size_t>(name.size(), 0xFFFF);
+        Put(length);
+        m_buffer.insert(m_buffer.end(), name.begin(), name.begin() + length);
+    }
+    Capture(engine);
+    WriteKeyframe(engine.GetTick());
+    m_lastTick = engine.GetTick();
+    return true;
+}
+
+void ReplayRecorder::Record(const Engine& engine)
+{
+    if (!m_file)
+    {
+        return;
+    }
+    Capture(engine);
+    uint64_t tick = engine.GetTick();
+    if (tick % m_interval == 0)
+    {
+        WriteKeyframe(tick);
+    }
+    else
+    {
+        WriteDelta();
+    }
+    m_lastTick = tick;
+    if (m_buffer.size() >= FlushSize)
+    {
+        FlushBuffer();
+    }
+}
+
+void ReplayRecorder::Finish()
+{
+    if (!m_file)
+    {
+        return;
+    }
+    uint64_t index = m_offset + m_buffer.size();
+    for (uint64_t offset : m_keyframes)
+    {
+        Put(offset);
+    }
+    Put(index);
+    Put(static_cast<uint32_t>(m_keyframes.size()));
+    Put(m_lastTick);
+    m_buffer.insert(m_buffer.end(), std::begin(ReplayMagic), std::end(ReplayMagic));
+    FlushBuffer();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+uint64_t ReplayRecorder::GetBytesWritten() const
+{
+    return m_offset + m_buffer.size();
+}
+
+void ReplayRecorder::Capture(const Engine& engine)
+{
+    std::swap(m_robots, m_previousRobots);
+    std::swap(m_shots, m_previousShots);
+    const RobotStates& states = engine.GetStates();
+    const std::vector<std::shared_ptr<IRobot>>& robots = engine.GetRobots();
+    m_robots.resize(robots.size() * ReplayFieldCount);
+    for (uint32_t i = 0; i < robots.size(); i++)
+    {
+        int32_t* fields = &m_robots[i * ReplayFieldCount];
+        fields[ReplayX] = ReplayQuantize(states.m_currentX[i], ReplayScales[ReplayX]);
+        fields[ReplayY] = ReplayQuantize(states.m_currentY[i], ReplayScales[ReplayY]);
+        fields[ReplayFacing] = ReplayQuantize(states.m_facing[i], ReplayScales[ReplayFacing]);
+        fields[ReplaySpeed] = ReplayQuantize(states.m_speed[i], ReplayScales[ReplaySpeed]);
+        fields[ReplayDamage] = ReplayQuantize(states.m_damage[i], ReplayScales[ReplayDamage]);
+        fields[ReplayScanDir] = ReplayQuantize(robots[i]->GetScanDir(), ReplayScales[ReplayScanDir]);
+        fields[ReplayResolution] = ReplayQuantize(robots[i]->GetResolution(), ReplayScales[ReplayResolution]);
+    }
+    const ShotPool& shots = engine.GetShots();
+    m_shots.resize(shots.GetCount() * 2);
+    for (uint32_t i = 0; i < shots.GetCount(); i++)
+    {
+        m_shots[i * 2] = ReplayQuantize(shots.m_currentX[i], ReplayShotScale);
+        m_shots[i * 2 + 1] = ReplayQuantize(shots.m_currentY[i], ReplayShotScale);
+    }
+}
+
+void ReplayRecorder::WriteKeyframe(uint64_t tick)
+{
+    m_keyframes.push_back(m_offset + m_buffer.size());
+    m_buffer.push_back(ReplayKeyframe);
+    PutVarint(tick);
+    for (int32_t value : m_robots)
+    {
+        PutSigned(value);
+    }
+    PutVarint(m_shots.size() / 2);
+    for (int32_t value : m_shots)
+    {
+        PutSigned(value);
+    }
+}
+
+void ReplayRecorder::WriteDelta()
+{
+    m_buffer.push_back(ReplayDelta);
+    for (size_t i = 0; i < m_robots.size(); i += ReplayFieldCount)
+    {
+        uint8_t mask = 0;
+        for (uint32_t field = 0; field < ReplayFieldCount; field++)
+        {
+            mask |= (m_robots[i + field] != m_previousRobots[i + field]) << field;
+        }
+        m_buffer.push_back(mask);
+        for (uint32_t field = 0; field < ReplayFieldCount; field++)
+        {
+            if (mask & (1 << field))
+            {
+                PutSigned(int64_t{m_robots[i + field]} - m_previousRobots[i + field]);
+            }
+        }
+    }
+    PutVarint(m_shots.size() / 2);
+    for (size_t i = 0; i < m_shots.size(); i++)
+    {
+        int32_t previous = i < m_previousShots.size() ? m_previousShots[i] : 0;
+        PutSigned(int64_t{m_shots[i]} - previous);
+    }
+}
+
+void ReplayRecorder::PutVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    m_buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void ReplayRecorder::PutSigned(int64_t value)
+{
+    PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+template<typename T>
+void ReplayRecorder::Put(const T& value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void ReplayRecorder::FlushBuffer()
+{
+    std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    m_offset += m_buffer.size();
+    m_buffer.clear();
+}
+
+ReplayReader::ReplayReader()
+    : m_data{nullptr}
+    , m_size{0}
+    , m_cursor{0}
+    , m_end{0}
+    , m_arenaX{0}
+    , m_arenaY{0}
+    , m_seed{0}
+    , m_interval{1}
+    , m_lastTick{0}
+    , m_keyframes{0}
+    , m_index{0}
+    , m_tick{0}
+{}
+
+ReplayReader::~ReplayReader()
+{
+    Close();
+}
+
+bool ReplayReader::Open(const std::string& path)
+{
+    Close();
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    m_copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_copy.data();
+    m_size = m_copy.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = st.st_size;
+#endif
+
+    if (m_size < sizeof(ReplayMagic) + FooterSize ||
+        std::memcmp(m_data, ReplayMagic, sizeof(ReplayMagic)) != 0 ||
+        std::memcmp(m_data + m_size - sizeof(ReplayMagic), ReplayMagic, sizeof(ReplayMagic)) != 0)
+    {
+        Close();
+        return false;
+    }
+    uint64_t index = 0;
+    m_cursor = m_size - FooterSize;
+    m_end = m_size;
+    Read(index);
+    Read(m_keyframes);
+    Read(m_lastTick);
+    if (index > m_size - FooterSize || (m_size - FooterSize - index) / sizeof(uint64_t) < m_keyframes)
+    {
+        Close();
+        return false;
+    }
+    m_index = index;
+
+    m_cursor = sizeof(ReplayMagic);
+    m_end = m_index;
+    uint32_t count = 0;
+    bool ok = Read(m_arenaX) && Read(m_arenaY) && Read(m_seed) && Read(m_interval) && Read(count);
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        uint16_t length = 0;
+        ok = Read(length) && m_end - m_cursor >= length;
+        if (ok)
+        {
+            m_names.emplace_back(reinterpret_cast<const char*>(m_data + m_cursor), length);
+            m_cursor += length;
+        }
+    }
+    if (!ok || m_interval == 0 || m_keyframes == 0)
+    {
+        Close();
+        return false;
+    }
+    m_robots.assign(count * ReplayFieldCount, 0);
+    return true;
+}
+
+void ReplayReader::Close()
+{
+#if !defined(_WIN32)
+    if (m_data)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_copy.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_names.clear();
+}
+
+uint32_t ReplayReader::GetArenaX() const
+{
+    return m_arenaX;
+}
+
+uint32_t ReplayReader::GetArenaY() const
+{
+    return m_arenaY;
+}
+
+uint64_t ReplayReader::GetSeed() const
+{
+    return m_seed;
+}
+
+const std::vector<std::string>& ReplayReader::GetNames() const
+{
+    return m_names;
+}
+
+uint64_t ReplayReader::GetLastTick() const
+{
+    return m_lastTick;
+}
+
+bool ReplayReader::Seek(uint64_t tick, ReplayFrame& frame)
+{
+    if (!m_data || tick > m_lastTick)
+    {
+        return false;
+    }
+    // Keyframes are written every m_interval ticks from the first one, so the one to start
+    // from is found by division rather than by searching.
+    uint64_t first = 0;
+    std::memcpy(&first, m_data + m_index, sizeof(first));
+    if (first >= m_end)
+    {
+        return false;
+    }
+    m_cursor = first;
+    uint64_t firstTick = 0;
+    if (!(m_data[m_cursor++] == ReplayKeyframe && ReadVarint(firstTick)) || tick < firstTick)
+    {
+        return false;
+    }
+    uint64_t keyframe = std::min<uint64_t>((tick / m_interval) - (firstTick / m_interval), m_keyframes - 1);
+    uint64_t offset = 0;
+    std::memcpy(&offset, m_data + m_index + keyframe * sizeof(uint64_t), sizeof(offset));
+    if (offset >= m_end)
+    {
+        return false;
+    }
+    m_cursor = offset;
+    if (!DecodeFrame())
+    {
+        return false;
+    }
+    while (m_tick < tick)
+    {
+        if (!DecodeFrame())
+        {
+            return false;
+        }
+    }
+    Fill(frame);
+    return true;
+}
+
+bool ReplayReader::Next(ReplayFrame& frame)
+{
+    if (!m_data || m_tick >= m_lastTick || !DecodeFrame())
+    {
+        return false;
+    }
+    Fill(frame);
+    return true;
+}
+
+bool ReplayReader::DecodeFrame()
+{
+    uint8_t type = 0;
+    if (!Read(type))
+    {
+        return false;
+    }
+    uint64_t shots = 0;
+    if (type == ReplayKeyframe)
+    {
+        if (!ReadVarint(m_tick))
+        {
+            return false;
+        }
+        for (int32_t& value : m_robots)
+        {
+            int64_t v = 0;
+            if (!ReadSigned(v))
+            {
+                return false;
+            }
+            value = v;
+        }
+        if (!ReadVarint(shots) || shots > (m_end - m_cursor))
+        {
+            return false;
+        }
+        m_shots.resize(shots * 2);
+        for (int32_t& value : m_shots)
+        {
+            int64_t v = 0;
+            if (!ReadSigned(v))
+            {
+                return false;
+            }
+            value = v;
+        }
+        return true;
+    }
+    if (type != ReplayDelta)
+    {
+        return false;
+    }
+    m_tick++;
+    for (size_t i = 0; i < m_robots.size(); i += ReplayFieldCount)
+    {
+        uint8_t mask = 0;
+        if (!Read(mask))
+        {
+            return false;
+        }
+        for (uint32_t field = 0; field < ReplayFieldCount; field++)
+        {
+            int64_t delta = 0;
+            if ((mask & (1 << field)) && !ReadSigned(delta))
+            {
+                return false;
+            }
+            m_robots[i + field] += delta;
+        }
+    }
+    if (!ReadVarint(shots) || shots > (m_end - m_cursor))
+    {
+        return false;
+    }
+    m_shots.resize(shots * 2, 0);
+    for (int32_t& value : m_shots)
+    {
+        int64_t delta = 0;
+        if (!ReadSigned(delta))
+        {
+            return false;
+        }
+        value += delta;
+    }
+    return true;
+}
+
+void ReplayReader::Fill(ReplayFrame& frame) const
+{
+    frame.tick = m_tick;
+    frame.robots.resize(m_robots.size() / ReplayFieldCount);
+    for (size_t i = 0; i < frame.robots.size(); i++)
+    {
+        for (uint32_t field = 0; field < ReplayFieldCount; field++)
+        {
+            frame.robots[i].fields[field] = m_robots[i * ReplayFieldCount + field] / ReplayScales[field];
+        }
+    }
+    frame.shots.resize(m_shots.size() / 2);
+    for (size_t i = 0; i < frame.shots.size(); i++)
+    {
+        frame.shots[i] = {m_shots[i * 2] / ReplayShotScale, m_shots[i * 2 + 1] / ReplayShotScale};
+    }
+}
+
+bool ReplayReader::ReadVarint(uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        if (m_cursor >= m_end)
+        {
+            return false;
+        }
+        uint8_t byte = m_data[m_cursor++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReplayReader::ReadSigned(int64_t& value)
+{
+    uint64_t raw = 0;
+    if (!ReadVarint(raw))
+    {
+        return false;
+    }
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+template<typename T>
+bool ReplayReader::Read(T& value)
+{
+    if (m_end - m_cursor < sizeof(T))
+    {
+        return false;
+    }
+    std::memcpy(&value, m_data + m_cursor, sizeof(T));
+    m_cursor += sizeof(T);
+    return true;
+}
+
+}
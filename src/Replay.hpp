@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Crobots
+{
+
+class Engine;
+
+// Replays are a header, a keyframe every few ticks, a delta for every other tick and a
+// keyframe index at the end. Values are quantized to fixed point (ReplayScales) and
+// written as zigzag varints; a delta stores, per robot, a mask of the fields that changed
+// followed by their differences, so a robot moving in a straight line costs three bytes.
+//
+// Header:   ReplayMagic, u32 arena x, u32 arena y, u64 seed, u32 keyframe interval,
+//           u32 robots, then u16 length + name for each robot
+// Keyframe: u8 ReplayKeyframe, varint tick, every robot field, varint shots, shot x/y
+// Delta:    u8 ReplayDelta, for each robot u8 mask + changed fields, varint shots,
+//           shot x/y relative to whatever shot was at the same index last tick (or to 0
+//           past last tick's count). The pool swap-removes, so after a detonation that
+//           can be a different shot.
+// Footer:   u64 offset of each keyframe, u64 index offset, u32 keyframes, u64 last tick,
+//           ReplayMagic
+inline constexpr char ReplayMagic[8] = {'C', 'R', 'B', 'R', 'P', 'L', 'Y', '1'};
+inline constexpr uint8_t ReplayKeyframe = 1;
+inline constexpr uint8_t ReplayDelta = 2;
+
+enum ReplayField
+{
+    ReplayX,
+    ReplayY,
+    ReplayFacing,
+    ReplaySpeed,
+    ReplayDamage,
+    ReplayScanDir,
+    ReplayResolution,
+    ReplayFieldCount,
+};
+// Units per meter, degree or percent for each field, and for shot coordinates.
+inline constexpr float ReplayScales[ReplayFieldCount] = {32, 32, 8, 4, 4, 8, 8};
+inline constexpr float ReplayShotScale = 32;
+
+int32_t ReplayQuantize(float value, float scale);
+
+struct ReplayRobot
+{
+    float fields[ReplayFieldCount];
+};
+
+struct ReplayShot
+{
+    float x;
+    float y;
+};
+
+// The state of the match after a tick, as recorded.
+struct ReplayFrame
+{
+    uint64_t tick;
+    std::vector<ReplayRobot> robots;
+    std::vector<ReplayShot> shots;
+};
+
+// Writes a replay of an engine's match. Engine::Tick calls Record once the recorder is
+// attached with Engine::SetRecorder.
+class ReplayRecorder
+{
+public:
+    ReplayRecorder();
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+    ~ReplayRecorder();
+
+    // Write the header and a keyframe of the engine's current state. The engine must have
+    // its robots loaded.
+    bool Start(const std::string& path, const Engine& engine, uint32_t keyframeInterval = 256);
+    void Record(const Engine& engine);
+    // Write the index and close the file.
+    void Finish();
+    uint64_t GetBytesWritten() const;
+
+private:
+    void Capture(const Engine& engine);
+    void WriteKeyframe(uint64_t tick);
+    void WriteDelta();
+    void PutVarint(uint64_t value);
+    void PutSigned(int64_t value);
+    template<typename T>
+    void Put(const T& value);
+    void FlushBuffer();
+
+    std::FILE* m_file;
+    std::vector<uint8_t> m_buffer;
+    uint64_t m_offset;
+    uint32_t m_interval;
+    uint64_t m_lastTick;
+    std::vector<uint64_t> m_keyframes;
+    // Quantized fields, ReplayFieldCount per robot, and x/y per shot, for this tick and
+    // the last one written.
+    std::vector<int32_t> m_robots;
+    std::vector<int32_t> m_shots;
+    std::vector<int32_t> m_previousRobots;
+    std::vector<int32_t> m_previousShots;
+};
+
+// Reads a finished replay. The file is memory mapped; seeking to a tick goes straight to
+// the keyframe at or before it through the index and decodes forward from there.
+class ReplayReader
+{
+public:
+    ReplayReader();
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+    ~ReplayReader();
+
+    bool Open(const std::string& path);
+    void Close();
+    uint32_t GetArenaX() const;
+    uint32_t GetArenaY() const;
+    uint64_t GetSeed() const;
+    const std::vector<std::string>& GetNames() const;
+    uint64_t GetLastTick() const;
+    // Decode the frame for tick.
+    bool Seek(uint64_t tick, ReplayFrame& frame);
+    // Decode the frame after the last one decoded.
+    bool Next(ReplayFrame& frame);
+
+private:
+    bool ReadVarint(uint64_t& value);
+    bool ReadSigned(int64_t& value);
+    template<typename T>
+    bool Read(T& value);
+    bool DecodeFrame();
+    void Fill(ReplayFrame& frame) const;
+
+    const uint8_t* m_data;
+    size_t m_size;
+    std::vector<uint8_t> m_copy;
+    size_t m_cursor;
+    size_t m_end;
+    uint32_t m_arenaX;
+    uint32_t m_arenaY;
+    uint64_t m_seed;
+    uint32_t m_interval;
+    uint64_t m_lastTick;
+    uint32_t m_keyframes;
+    size_t m_index;
+    std::vector<std::string> m_names;
+    uint64_t m_tick;
+    std::vector<int32_t> m_robots;
+    std::vector<int32_t> m_shots;
+};
+
+}
@@ -0,0 +1,31 @@
+#include "RobotStates.hpp"
+
+namespace Crobots
+{
+
+void RobotStates::Resize(uint32_t count)
+{
+    m_currentX.assign(count, 0.0f);
+    m_currentY.assign(count, 0.0f);
+    m_nextX.assign(count, 0.0f);
+    m_nextY.assign(count, 0.0f);
+    m_speed.assign(count, 0.0f);
+    m_desiredSpeed.assign(count, 0.0f);
+    m_facing.assign(count, 0.0f);
+    m_desiredFacing.assign(count, 0.0f);
+    m_damage.assign(count, 0.0f);
+    m_reloadTick.assign(count, 0);
+    m_scanTick.assign(count, 0);
+    // This will need to eventually use a unique robot profile, but for now
+    // everyone gets the same attributes.
+    m_acceleration.assign(count, 1.0f);
+    m_braking.assign(count, 5.0f);
+    m_turnRate.assign(count, 5.0f);
+}
+
+uint32_t RobotStates::GetCount() const
+{
+    return m_currentX.size();
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Crobots
+{
+
+// The engine-owned physical state of every robot, stored as one contiguous array per
+// field and indexed by the robot's position in Engine::GetRobots(). The per-tick sweeps
+// in Engine walk these arrays linearly instead of chasing pointers into each IRobot, and
+// IRobot reads and writes its own slot through the index the engine hands it on Load.
+class RobotStates
+{
+public:
+    // Resize every array to count entries, each reset to the initial robot state.
+    void Resize(uint32_t count);
+    uint32_t GetCount() const;
+
+    // Current X and Y location. Floats for more accurate resolution, but the LocX and LocY
+    // methods return integers, rounded off.
+    std::vector<float> m_currentX;
+    std::vector<float> m_currentY;
+    // Post-move X and Y location.
+    std::vector<float> m_nextX;
+    std::vector<float> m_nextY;
+    // Current speed, and the speed we are trying to achieve.
+    std::vector<float> m_speed;
+    std::vector<float> m_desiredSpeed;
+    // Facing we currently have, and the facing we would like to have.
+    std::vector<float> m_facing;
+    std::vector<float> m_desiredFacing;
+    // How much we are hurt.
+    std::vector<float> m_damage;
+    // Tick on which the cannon has reloaded, and the tick on which the scanner can scan
+    // again. Deadlines rather than countdowns, so nothing has to tick them down.
+    std::vector<uint64_t> m_reloadTick;
+    std::vector<uint64_t> m_scanTick;
+
+    // Some performance parameters for the future.
+    std::vector<float> m_acceleration;
+    std::vector<float> m_braking;
+    std::vector<float> m_turnRate;
+};
+
+}
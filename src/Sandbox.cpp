@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <link.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Crobots++/Log.hpp"
+#include "CpuBudget.hpp"
+#include "Sandbox.hpp"
+
+namespace
+{
+
+// How often a parent waiting on a sandbox checks that the child is still alive.
+static constexpr uint64_t AliveCheckNs = 5000000;
+
+uint32_t RingCapacity(uint32_t recordSize)
+{
+    // Room for two records plus headers and the end-of-ring padding; only one record is in
+    // flight in each direction at a time.
+    return std::bit_ceil(std::max<uint32_t>(4096, 4 * (recordSize + 16)));
+}
+
+size_t AlignUp(size_t size)
+{
+    return (size + 63) & ~size_t(63);
+}
+
+// Where the two rings go in a sandbox's shared memory.
+struct RingLayout
+{
+    uint32_t snapshotCapacity;
+    uint32_t intentCapacity;
+    size_t intentOffset;
+    size_t size;
+};
+
+RingLayout GetLayout(uint32_t count)
+{
+    RingLayout layout;
+    layout.snapshotCapacity = RingCapacity(Crobots::SandboxSnapshot::GetSize(count));
+    layout.intentCapacity = RingCapacity(Crobots::SandboxIntent::GetSize(count));
+    layout.intentOffset = AlignUp(Crobots::SharedRing::GetSize(layout.snapshotCapacity));
+    layout.size = layout.intentOffset + AlignUp(Crobots::SharedRing::GetSize(layout.intentCapacity));
+    return layout;
+}
+
+#if defined(__linux__)
+
+// The engine's end of the socket to the helper, and what children run. Requests and
+// their replies are paired, so engines starting sandboxes on several threads take turns.
+static int g_helper = -1;
+static std::mutex g_helperMutex;
+static Crobots::SandboxServe g_serve = nullptr;
+static pid_t g_engineProcess = -1;
+
+// A spec goes to the helper as one message, with the shared memory's descriptor attached.
+bool SendSpec(int socket, const Crobots::SandboxSpec& spec, int fd)
+{
+    iovec data{const_cast<Crobots::SandboxSpec*>(&spec), sizeof(spec)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+    return sendmsg(socket, &message, MSG_NOSIGNAL) == sizeof(spec);
+}
+
+bool ReceiveSpec(int socket, Crobots::SandboxSpec& spec, int& fd)
+{
+    iovec data{&spec, sizeof(spec)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t received;
+    while ((received = recvmsg(socket, &message, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR)
+    {
+    }
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (received != sizeof(spec) || !header || header->cmsg_type != SCM_RIGHTS)
+    {
+        return false;
+    }
+    std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+    spec.modulePath[sizeof(spec.modulePath) - 1] = '\0';
+    return true;
+}
+
+#endif
+
+}
+
+namespace Crobots
+{
+
+Sandbox::Sandbox(uint32_t count)
+: Sandbox(count, -1)
+{}
+
+Sandbox::Sandbox(uint32_t count, int fd)
+: m_count{count}
+, m_snapshotSize{SandboxSnapshot::GetSize(count)}
+, m_intentSize{SandboxIntent::GetSize(count)}
+, m_fd{fd}
+, m_memory{nullptr}
+, m_memorySize{0}
+, m_snapshots{}
+, m_intents{}
+, m_pid{-1}
+, m_pidfd{-1}
+{
+#if defined(__linux__)
+    RingLayout layout = GetLayout(count);
+    if (m_fd < 0)
+    {
+        // Shared memory that can be handed to a process we did not fork.
+        m_fd = memfd_create("crobots_sandbox", MFD_CLOEXEC);
+        if (m_fd < 0 || ftruncate(m_fd, layout.size) != 0)
+        {
+            CROBOTS_LOG_ERROR(Engine, "Sandbox: cannot create {} bytes of shared memory", layout.size);
+            return;
+        }
+    }
+    void* memory = mmap(nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (memory == MAP_FAILED)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Sandbox: cannot map {} bytes of shared memory", layout.size);
+        return;
+    }
+    m_memory = memory;
+    m_memorySize = layout.size;
+    if (fd >= 0)
+    {
+        // The child's side: Start laid the rings out before asking for the child.
+        m_snapshots = SharedRing::Attach(m_memory);
+        m_intents = SharedRing::Attach(static_cast<char*>(m_memory) + layout.intentOffset);
+    }
+#endif
+}
+
+Sandbox::~Sandbox()
+{
+    Stop();
+#if defined(__linux__)
+    if (m_memory)
+    {
+        munmap(m_memory, m_memorySize);
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+#endif
+}
+
+bool Sandbox::StartHelper(SandboxServe serve)
+{
+#if defined(__linux__)
+    if (g_helper >= 0)
+    {
+        return true;
+    }
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sockets) != 0)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Sandbox: cannot make a socket for the sandbox helper");
+        return false;
+    }
+    g_serve = serve;
+    g_engineProcess = getpid();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Sandbox: cannot fork the sandbox helper");
+        close(sockets[0]);
+        close(sockets[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        close(sockets[0]);
+        RunHelper(sockets[1]);
+    }
+    close(sockets[1]);
+    g_helper = sockets[0];
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Sandbox::RunHelper(int socket)
+{
+#if defined(__linux__)
+    // Never outlive the engine, even if it dies without cleaning up.
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() != g_engineProcess)
+    {
+        _exit(0);
+    }
+    // Children are reaped as they exit; the engine watches them through pidfds.
+    std::signal(SIGCHLD, SIG_IGN);
+    pid_t helper = getpid();
+    for (;;)
+    {
+        SandboxSpec spec;
+        int fd = -1;
+        if (!ReceiveSpec(socket, spec, fd))
+        {
+            // The engine's end is closed: it has exited.
+            _exit(0);
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (getppid() != helper)
+            {
+                _exit(0);
+            }
+            close(socket);
+            std::signal(SIGCHLD, SIG_DFL);
+            Sandbox sandbox(spec.count, fd);
+            if (sandbox.m_memory)
+            {
+                g_serve(spec, sandbox);
+            }
+            // Skip atexit handlers and stdio buffers, which belong to the engine's process.
+            _exit(0);
+        }
+        close(fd);
+        send(socket, &pid, sizeof(pid), MSG_NOSIGNAL);
+    }
+#else
+    std::abort();
+#endif
+}
+
+bool Sandbox::DescribeFactory(GetRobotFunc create, SandboxSpec& spec)
+{
+#if defined(__linux__)
+    Dl_info info;
+    link_map* object = nullptr;
+    if (!create || !dladdr1(reinterpret_cast<void*>(create), &info, reinterpret_cast<void**>(&object), RTLD_DL_LINKMAP) ||
+        !object || std::strlen(object->l_name) >= sizeof(spec.modulePath))
+    {
+        return false;
+    }
+    // The program's own name is empty.
+    std::strcpy(spec.modulePath, object->l_name);
+    spec.factoryOffset = reinterpret_cast<uintptr_t>(create) - object->l_addr;
+    return true;
+#else
+    return false;
+#endif
+}
+
+GetRobotFunc Sandbox::FindFactory(const SandboxSpec& spec)
+{
+#if defined(__linux__)
+    // Kept open for as long as the child lives.
+    void* handle = dlopen(spec.modulePath[0] ? spec.modulePath : nullptr, RTLD_NOW);
+    link_map* object = nullptr;
+    if (!handle || dlinfo(handle, RTLD_DI_LINKMAP, &object) != 0)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Sandbox: cannot load {}: {}", spec.modulePath, dlerror());
+        return nullptr;
+    }
+    return reinterpret_cast<GetRobotFunc>(object->l_addr + spec.factoryOffset);
+#else
+    return nullptr;
+#endif
+}
+
+bool Sandbox::Start(const SandboxSpec& spec)
+{
+#if defined(__linux__)
+    Stop();
+    if (!m_memory)
+    {
+        return false;
+    }
+    RingLayout layout = GetLayout(m_count);
+    m_snapshots = SharedRing::Create(m_memory, layout.snapshotCapacity);
+    m_intents = SharedRing::Create(static_cast<char*>(m_memory) + layout.intentOffset, layout.intentCapacity);
+    pid_t pid = -1;
+    {
+        std::lock_guard<std::mutex> lock(g_helperMutex);
+        if (g_helper < 0)
+        {
+            CROBOTS_LOG_ERROR(Engine, "Sandbox: the sandbox helper is not running");
+            return false;
+        }
+        if (!SendSpec(g_helper, spec, m_fd) || recv(g_helper, &pid, sizeof(pid), 0) != sizeof(pid))
+        {
+            pid = -1;
+        }
+    }
+    if (pid < 0)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Sandbox: the sandbox helper cannot fork");
+        return false;
+    }
+    m_pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (m_pidfd < 0)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Sandbox: cannot watch child {}", pid);
+        kill(pid, SIGKILL);
+        return false;
+    }
+    m_pid = pid;
+    return true;
+#else
+    CROBOTS_LOG_ERROR(Engine, "Sandbox: robot sandboxes are not supported on this platform");
+    return false;
+#endif
+}
+
+void Sandbox::Stop()
+{
+#if defined(__linux__)
+    if (m_pid > 0)
+    {
+        syscall(SYS_pidfd_send_signal, m_pidfd, SIGKILL, nullptr, 0);
+        pollfd gone{m_pidfd, POLLIN, 0};
+        while (poll(&gone, 1, -1) < 0 && errno == EINTR)
+        {
+        }
+        close(m_pidfd);
+        m_pidfd = -1;
+        m_pid = -1;
+    }
+#endif
+}
+
+bool Sandbox::IsRunning() const
+{
+    return m_pid > 0;
+}
+
+SandboxSnapshot* Sandbox::BeginSnapshot()
+{
+    return static_cast<SandboxSnapshot*>(m_snapshots.Reserve(m_snapshotSize));
+}
+
+void Sandbox::PostSnapshot()
+{
+    m_snapshots.Publish();
+}
+
+const SandboxIntent* Sandbox::WaitIntent(uint64_t deadlineNs)
+{
+#if defined(__linux__)
+    uint32_t size = 0;
+    while (m_pid > 0)
+    {
+        // An intent that is already there counts, however late it is to look for it.
+        uint64_t now = SteadyNanoseconds();
+        uint64_t timeout = now < deadlineNs ? std::min(deadlineNs - now, AliveCheckNs) : 0;
+        const void* intent = m_intents.Wait(timeout, size);
+        if (intent && size == m_intentSize)
+        {
+            return static_cast<const SandboxIntent*>(intent);
+        }
+        if (intent || size == SharedRing::BadRecord)
+        {
+            CROBOTS_LOG_WARN(Engine, "Sandbox: child {} wrote a malformed intent", m_pid);
+            Stop();
+            return nullptr;
+        }
+        if (timeout == 0)
+        {
+            return nullptr;
+        }
+        pollfd gone{m_pidfd, POLLIN, 0};
+        if (poll(&gone, 1, 0) > 0)
+        {
+            close(m_pidfd);
+            m_pidfd = -1;
+            m_pid = -1;
+        }
+    }
+#endif
+    return nullptr;
+}
+
+void Sandbox::ReleaseIntent()
+{
+    m_intents.Release();
+}
+
+const SandboxSnapshot* Sandbox::WaitSnapshot()
+{
+    uint32_t size = 0;
+    const void* snapshot = nullptr;
+    while (!snapshot)
+    {
+        snapshot = m_snapshots.Wait(std::numeric_limits<uint32_t>::max(), size);
+    }
+    return static_cast<const SandboxSnapshot*>(snapshot);
+}
+
+void Sandbox::ReleaseSnapshot()
+{
+    m_snapshots.Release();
+}
+
+SandboxIntent* Sandbox::BeginIntent()
+{
+    return static_cast<SandboxIntent*>(m_intents.Reserve(m_intentSize));
+}
+
+void Sandbox::PostIntent()
+{
+    m_intents.Publish();
+}
+
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Crobots++/IRobot.hpp"
+#include "SharedRing.hpp"
+
+namespace Crobots
+{
+
+struct SandboxConfig
+{
+    // Run every robot in a child process of its own.
+    bool enabled{false};
+    // Wall clock time a sandboxed robot has to answer a tick before it is taken out of
+    // the match.
+    uint64_t deadlineNs{250000000};
+};
+
+// What a sandbox's child needs to set up its own copy of the match. The child starts out
+// as a copy of the process from before it had any threads, so it has no engine and no
+// robots: it makes an engine of the same arena and seed, and its robot with the same
+// factory, found again by its offset in the program or in the module at modulePath.
+struct SandboxSpec
+{
+    uint32_t arenaX;
+    uint32_t arenaY;
+    uint64_t seed;
+    uint32_t count;
+    uint32_t index;
+    uintptr_t factoryOffset;
+    // Empty for a factory in the program itself.
+    char modulePath[1024];
+};
+
+// What a sandboxed robot gets to see of the match each tick: its own slot of the
+// engine's RobotStates, and where every robot is. Followed by count X positions and then
+// count Y positions. A reset snapshot instead starts the next match with seed.
+struct SandboxSnapshot
+{
+    uint64_t tick;
+    uint64_t seed;
+    uint64_t reloadTick;
+    uint64_t scanTick;
+    float speed;
+    float desiredSpeed;
+    float facing;
+    float desiredFacing;
+    float damage;
+    uint32_t count;
+    bool detected;
+    bool reset;
+
+    float* GetX() { return reinterpret_cast<float*>(this + 1); }
+    float* GetY() { return GetX() + count; }
+    const float* GetX() const { return reinterpret_cast<const float*>(this + 1); }
+    const float* GetY() const { return GetX() + count; }
+
+    static uint32_t GetSize(uint32_t count) { return sizeof(SandboxSnapshot) + count * 2 * sizeof(float); }
+};
+
+// What a sandboxed robot did during its tick. Followed by hitCount indices of the robots
+// its scan found.
+struct SandboxIntent
+{
+    uint64_t scanTick;
+    // CPU time the robot spent in Tick.
+    uint64_t cpuNs;
+    float desiredSpeed;
+    float desiredFacing;
+    float scanDir;
+    float resolution;
+    float shotDegree;
+    float shotRange;
+    uint32_t hitCount;
+    bool shot;
+
+    uint32_t* GetHits() { return reinterpret_cast<uint32_t*>(this + 1); }
+    const uint32_t* GetHits() const { return reinterpret_cast<const uint32_t*>(this + 1); }
+
+    static uint32_t GetSize(uint32_t count) { return sizeof(SandboxIntent) + count * sizeof(uint32_t); }
+};
+
+class Sandbox;
+
+// The child's side of a sandbox: set up the match spec describes and serve its robot's
+// ticks until killed.
+using SandboxServe = void (*)(const SandboxSpec& spec, Sandbox& sandbox);
+
+// A child process that one robot runs in, so that a crash or a hang takes down only that
+// robot. Children are not forked from the engine, which by then has threads whose locks a
+// child could inherit held, but by a helper the process forks at startup while it has
+// only the one thread. The child only talks to the engine through two SharedRings in
+// memory they share: snapshots go in, intents come out. The child outlives its match, so
+// one sandbox serves any number of matches with the same robot.
+// Linux only; elsewhere Start fails.
+class Sandbox
+{
+public:
+    // Rings sized for snapshots and intents of a match with count robots.
+    explicit Sandbox(uint32_t count);
+    Sandbox(const Sandbox&) = delete;
+    Sandbox& operator=(const Sandbox&) = delete;
+    // Kills the child if it is still running.
+    ~Sandbox();
+
+    // Fork the helper that forks every child, which runs serve. Call it while the process
+    // has a single thread, before anything starts another; without it Start fails.
+    static bool StartHelper(SandboxServe serve);
+    // Fill in where the factory is, for spec. False if it is in no loaded object.
+    static bool DescribeFactory(GetRobotFunc create, SandboxSpec& spec);
+    // In the child: the factory spec describes, loading its module if need be.
+    static GetRobotFunc FindFactory(const SandboxSpec& spec);
+
+    // Have the helper fork a child for spec, stopping any child already running, with
+    // both rings empty. Returns false if there is no child.
+    bool Start(const SandboxSpec& spec);
+    // Kill the child and wait for it to be gone. Its robot gets no more ticks.
+    void Stop();
+    bool IsRunning() const;
+
+    // Parent side. Post a snapshot, then wait up to the deadline (a steady clock time in
+    // nanoseconds) for the intent, which is nullptr if the child died or ran out of time.
+    // The child can write anything into the rings: BeginSnapshot is nullptr if it left no
+    // room, and an intent that is not of the size the match's intents have stops the child.
+    // What is inside an intent is for the caller to check.
+    SandboxSnapshot* BeginSnapshot();
+    void PostSnapshot();
+    const SandboxIntent* WaitIntent(uint64_t deadlineNs);
+    void ReleaseIntent();
+
+    // Child side. WaitSnapshot waits for as long as it takes.
+    const SandboxSnapshot* WaitSnapshot();
+    void ReleaseSnapshot();
+    SandboxIntent* BeginIntent();
+    void PostIntent();
+
+private:
+    // The child's side, on the shared memory the engine's side made.
+    Sandbox(uint32_t count, int fd);
+    // The helper's loop: fork a child for every spec the engine sends.
+    [[noreturn]] static void RunHelper(int socket);
+
+    uint32_t m_count;
+    uint32_t m_snapshotSize;
+    uint32_t m_intentSize;
+    // The shared memory, which the helper hands on to every child it forks.
+    int m_fd;
+    void* m_memory;
+    size_t m_memorySize;
+    SharedRing m_snapshots;
+    SharedRing m_intents;
+    int m_pid;
+    // Becomes readable when the child is gone, however it went.
+    int m_pidfd;
+};
+
+}
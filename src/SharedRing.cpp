@@ -0,0 +1,196 @@
+#include <cassert>
+#include <chrono>
+#include <new>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "SharedRing.hpp"
+
+namespace
+{
+
+// Every record starts with its size, and records start on 8 byte boundaries.
+static constexpr uint32_t HeaderSize = 8;
+// Written in place of a size where the next record did not fit before the end of the ring.
+static constexpr uint32_t WrapMarker = 0xffffffff;
+// Polls before a waiting consumer goes to sleep. A round trip to a robot that answers
+// quickly stays in here and never pays for a wakeup. On a single core spinning only keeps
+// the other side from running, so go straight to sleep there.
+static const uint32_t SpinCount = std::thread::hardware_concurrency() > 1 ? 4000 : 0;
+
+uint32_t RecordSize(uint32_t size)
+{
+    return HeaderSize + ((size + 7) & ~7u);
+}
+
+void Pause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+}
+
+namespace Crobots
+{
+
+size_t SharedRing::GetSize(uint32_t capacity)
+{
+    return sizeof(Header) + capacity;
+}
+
+SharedRing::SharedRing(Header* header, uint32_t capacity)
+: m_header{header}
+, m_data{reinterpret_cast<char*>(header + 1)}
+, m_capacity{capacity}
+{}
+
+SharedRing SharedRing::Create(void* memory, uint32_t capacity)
+{
+    assert((capacity & (capacity - 1)) == 0 && capacity >= HeaderSize);
+    Header* header = new (memory) Header();
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->sleeping.store(0, std::memory_order_relaxed);
+    header->capacity = capacity;
+    return SharedRing(header, capacity);
+}
+
+SharedRing SharedRing::Attach(void* memory)
+{
+    Header* header = std::launder(static_cast<Header*>(memory));
+    return SharedRing(header, header->capacity);
+}
+
+void* SharedRing::Reserve(uint32_t size)
+{
+    uint32_t head = m_header->head.load(std::memory_order_relaxed);
+    uint32_t tail = m_header->tail.load(std::memory_order_acquire);
+    uint32_t total = RecordSize(size);
+    uint32_t offset = head & (m_capacity - 1);
+    // A record never wraps; if it does not fit before the end, it starts over at the front.
+    uint32_t skip = m_capacity - offset < total ? m_capacity - offset : 0;
+    if (head - tail > m_capacity || total + skip > m_capacity - (head - tail))
+    {
+        return nullptr;
+    }
+    if (skip > 0)
+    {
+        *reinterpret_cast<uint32_t*>(m_data + offset) = WrapMarker;
+        offset = 0;
+    }
+    *reinterpret_cast<uint32_t*>(m_data + offset) = size;
+    m_reserved = skip + total;
+    return m_data + offset + HeaderSize;
+}
+
+void SharedRing::Publish()
+{
+    // Sequentially consistent, so either the consumer sees the record before it sleeps or
+    // we see that it sleeps.
+    m_header->head.fetch_add(m_reserved, std::memory_order_seq_cst);
+    m_reserved = 0;
+    if (m_header->sleeping.load(std::memory_order_seq_cst))
+    {
+        Wake();
+    }
+}
+
+const void* SharedRing::Front(uint32_t& size) const
+{
+    uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+    uint32_t head = m_header->head.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+        return nullptr;
+    }
+    // Headers are aligned, so there is always room for one before the end of the ring.
+    uint32_t offset = tail & (m_capacity - 1);
+    uint32_t skip = 0;
+    if (offset % 8 == 0 && *reinterpret_cast<const uint32_t*>(m_data + offset) == WrapMarker)
+    {
+        skip = m_capacity - offset;
+        offset = 0;
+    }
+    size = offset % 8 == 0 ? *reinterpret_cast<const uint32_t*>(m_data + offset) : BadRecord;
+    // The record has to lie inside the ring and inside what was published.
+    if (size > m_capacity - offset - HeaderSize || skip + RecordSize(size) > head - tail)
+    {
+        size = BadRecord;
+        return nullptr;
+    }
+    return m_data + offset + HeaderSize;
+}
+
+const void* SharedRing::Wait(uint64_t timeoutNs, uint32_t& size)
+{
+    for (uint32_t spin = 0; spin < SpinCount; spin++)
+    {
+        if (const void* record = Front(size); record || size == BadRecord)
+        {
+            return record;
+        }
+        Pause();
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeoutNs);
+    for (;;)
+    {
+        uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+        m_header->sleeping.store(1, std::memory_order_seq_cst);
+        if (m_header->head.load(std::memory_order_seq_cst) == tail)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                m_header->sleeping.store(0, std::memory_order_relaxed);
+                return nullptr;
+            }
+#if defined(__linux__)
+            uint64_t left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+            timespec timeout{static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000)};
+            // Returns at once if a record was published since we looked.
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->head), FUTEX_WAIT, tail, &timeout, nullptr, 0);
+#else
+            std::this_thread::yield();
+#endif
+        }
+        m_header->sleeping.store(0, std::memory_order_relaxed);
+        if (const void* record = Front(size); record || size == BadRecord)
+        {
+            return record;
+        }
+    }
+}
+
+void SharedRing::Release()
+{
+    uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+    uint32_t size = 0;
+    if (!Front(size))
+    {
+        return;
+    }
+    uint32_t offset = tail & (m_capacity - 1);
+    uint32_t skip = *reinterpret_cast<const uint32_t*>(m_data + offset) == WrapMarker ? m_capacity - offset : 0;
+    m_header->tail.store(tail + skip + RecordSize(size), std::memory_order_release);
+}
+
+void SharedRing::Wake()
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->head), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Crobots
+{
+
+// A lock-free single-producer single-consumer queue of variable sized records, laid out in
+// a caller-provided block of memory so that it can live in a mapping shared by two
+// processes. Records are written and read in place: the producer reserves space, fills it
+// and publishes it; the consumer looks at the front record and releases it when done.
+// A consumer that finds the ring empty spins for a while and then sleeps on a futex, which
+// the producer only pays to wake when someone is asleep.
+// Each side has a SharedRing of its own that points at the memory, and keeps its own copy
+// of the capacity: whatever the other side writes there, a side never reads or writes
+// outside the ring. A record that does not fit in the ring is reported, not followed.
+class SharedRing
+{
+public:
+    // The size Front and Wait report for a record that does not fit in the ring, which only
+    // a broken or hostile producer writes. The ring is of no further use.
+    static constexpr uint32_t BadRecord = 0xffffffff;
+
+    // Bytes of memory needed for a ring with room for capacity bytes of records. Capacity
+    // must be a power of two.
+    static size_t GetSize(uint32_t capacity);
+
+    // Lay out an empty ring in memory, which must be GetSize(capacity) bytes and stay put
+    // for as long as the ring is used. Only one side does this; the other side attaches.
+    static SharedRing Create(void* memory, uint32_t capacity);
+    // The ring the other side laid out in memory, which is trusted for its capacity.
+    static SharedRing Attach(void* memory);
+
+    // A ring with no memory, to be assigned one made by Create or Attach.
+    SharedRing() = default;
+
+    // Space for a record of size bytes, or nullptr if the ring has no room for it now.
+    void* Reserve(uint32_t size);
+    // Hand the reserved record to the consumer.
+    void Publish();
+
+    // The front record, or nullptr if there is none or it is bad.
+    const void* Front(uint32_t& size) const;
+    // Wait up to timeoutNs for a record and return it, or nullptr if none arrived or the
+    // front one is bad.
+    const void* Wait(uint64_t timeoutNs, uint32_t& size);
+    // Drop the front record, making its space available to the producer again.
+    void Release();
+
+private:
+    // What lives at the start of the memory, followed by the records.
+    struct Header
+    {
+        // Bytes ever published and released. Both wrap; only their difference matters.
+        // The head doubles as the futex word consumers sleep on.
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        // Set while the consumer sleeps on head.
+        alignas(64) std::atomic<uint32_t> sleeping;
+        uint32_t capacity;
+    };
+
+    SharedRing(Header* header, uint32_t capacity);
+
+    void Wake();
+
+    Header* m_header{nullptr};
+    char* m_data{nullptr};
+    uint32_t m_capacity{0};
+    // The producer's reservation, not yet published.
+    uint32_t m_reserved{0};
+};
+
+}
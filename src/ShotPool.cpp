@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Crobots++/IRobot.hpp"
+#include "ShotPool.hpp"
+
+namespace Crobots
+{
+
+uint32_t ShotPool::Add(float x, float y, float facing, float speed, float range)
+{
+    // A shot that cannot move, or was given no (or a bogus) range, detonates where it is.
+    if (!(speed > 0 && range > 0))
+    {
+        speed = 0;
+        range = 0;
+    }
+    float radians = IRobot::ToRadians(facing);
+    float cosine = std::cos(radians);
+    float sine = std::sin(radians);
+    uint32_t id = m_index.size();
+    if (!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        m_index.push_back(0);
+    }
+    m_index[id] = m_currentX.size();
+    m_currentX.push_back(x);
+    m_currentY.push_back(y);
+    m_velocityX.push_back(speed * cosine);
+    m_velocityY.push_back(speed * sine);
+    m_targetX.push_back(x + range * cosine);
+    m_targetY.push_back(y + range * sine);
+    m_speed.push_back(speed);
+    m_facing.push_back(facing);
+    m_range.push_back(range);
+    m_id.push_back(id);
+    return id;
+}
+
+void ShotPool::Remove(uint32_t index)
+{
+    uint32_t last = m_currentX.size() - 1;
+    m_freeIds.push_back(m_id[index]);
+    if (index != last)
+    {
+        m_currentX[index] = m_currentX[last];
+        m_currentY[index] = m_currentY[last];
+        m_velocityX[index] = m_velocityX[last];
+        m_velocityY[index] = m_velocityY[last];
+        m_targetX[index] = m_targetX[last];
+        m_targetY[index] = m_targetY[last];
+        m_speed[index] = m_speed[last];
+        m_facing[index] = m_facing[last];
+        m_range[index] = m_range[last];
+        m_id[index] = m_id[last];
+        m_index[m_id[index]] = index;
+    }
+    m_currentX.pop_back();
+    m_currentY.pop_back();
+    m_velocityX.pop_back();
+    m_velocityY.pop_back();
+    m_targetX.pop_back();
+    m_targetY.pop_back();
+    m_speed.pop_back();
+    m_facing.pop_back();
+    m_range.pop_back();
+    m_id.pop_back();
+}
+
+void ShotPool::Clear()
+{
+    m_currentX.clear();
+    m_currentY.clear();
+    m_velocityX.clear();
+    m_velocityY.clear();
+    m_targetX.clear();
+    m_targetY.clear();
+    m_speed.clear();
+    m_facing.clear();
+    m_range.clear();
+    m_id.clear();
+    m_index.clear();
+    m_freeIds.clear();
+}
+
+void ShotPool::Reserve(uint32_t count)
+{
+    m_currentX.reserve(count);
+    m_currentY.reserve(count);
+    m_velocityX.reserve(count);
+    m_velocityY.reserve(count);
+    m_targetX.reserve(count);
+    m_targetY.reserve(count);
+    m_speed.reserve(count);
+    m_facing.reserve(count);
+    m_range.reserve(count);
+    m_id.reserve(count);
+    m_index.reserve(count);
+    m_freeIds.reserve(count);
+}
+
+uint32_t ShotPool::GetCount() const
+{
+    return m_currentX.size();
+}
+
+uint32_t ShotPool::GetIndex(uint32_t id) const
+{
+    return m_index[id];
+}
+
+uint64_t ShotPool::GetFlightTicks(uint32_t index) const
+{
+    if (m_speed[index] <= 0)
+    {
+        return 1;
+    }
+    // Cap absurd ranges well short of overflowing the tick counter.
+    double ticks = std::ceil(static_cast<double>(m_range[index]) / m_speed[index]);
+    return static_cast<uint64_t>(std::clamp(ticks, 1.0, 1e15));
+}
+
+void ShotPool::Integrate()
+{
+    uint32_t count = GetCount();
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    // Eight shots at a time; the scalar loop picks up the remainder.
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&m_currentX[i]);
+        __m256 y = _mm256_loadu_ps(&m_currentY[i]);
+        _mm256_storeu_ps(&m_currentX[i], _mm256_add_ps(x, _mm256_loadu_ps(&m_velocityX[i])));
+        _mm256_storeu_ps(&m_currentY[i], _mm256_add_ps(y, _mm256_loadu_ps(&m_velocityY[i])));
+    }
+#endif
+    IntegrateScalar(i, count);
+}
+
+void ShotPool::IntegrateScalar(uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        m_currentX[i] += m_velocityX[i];
+        m_currentY[i] += m_velocityY[i];
+    }
+}
+
+}
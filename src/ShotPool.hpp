@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Crobots
+{
+
+// Every shot in flight, stored as one contiguous array per field. Velocities are worked
+// out once when the shot is fired, so a tick is a straight add over the arrays. Shots
+// are swap-removed when they detonate; the arrays keep their capacity, so a match stops
+// allocating once it has seen its busiest tick. Each shot also gets an id that stays
+// valid while it is in flight, for things that outlive a swap-remove (scheduled events).
+class ShotPool
+{
+public:
+    // Add a shot at (x, y) heading facing degrees, moving speed meters per tick, that
+    // detonates after range meters. Returns its id.
+    uint32_t Add(float x, float y, float facing, float speed, float range);
+    // Swap-remove the shot at index; the last shot takes its place.
+    void Remove(uint32_t index);
+    void Clear();
+    // Make room for count shots in flight, so adding up to that many never allocates.
+    void Reserve(uint32_t count);
+    uint32_t GetCount() const;
+    // Index of the shot with the given id.
+    uint32_t GetIndex(uint32_t id) const;
+    // Number of ticks the shot at index flies before it reaches its target, at least one.
+    uint64_t GetFlightTicks(uint32_t index) const;
+    // Move every shot one tick along its velocity.
+    void Integrate();
+
+    // Current X and Y location.
+    std::vector<float> m_currentX;
+    std::vector<float> m_currentY;
+    // Distance moved along each axis per tick.
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+    // Where the shot detonates, range meters from where it was fired.
+    std::vector<float> m_targetX;
+    std::vector<float> m_targetY;
+    // Distance moved per tick.
+    std::vector<float> m_speed;
+    // Facing the shot was fired at, in degrees.
+    std::vector<float> m_facing;
+    // Distance from the firing point to the target.
+    std::vector<float> m_range;
+    // Id of the shot in each slot.
+    std::vector<uint32_t> m_id;
+
+private:
+    void IntegrateScalar(uint32_t begin, uint32_t end);
+
+    // Slot of each id, and the ids not in use.
+    std::vector<uint32_t> m_index;
+    std::vector<uint32_t> m_freeIds;
+};
+
+}
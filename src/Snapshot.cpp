@@ -0,0 +1,35 @@
+#include "Engine.hpp"
+#include "Snapshot.hpp"
+
+namespace Crobots
+{
+
+void Snapshot::Capture(const Engine& engine)
+{
+    tick = engine.GetTick();
+    arenaX = engine.GetArena().GetX();
+    arenaY = engine.GetArena().GetY();
+    debug = engine.DebugEnabled();
+    gameOver = engine.IsGameOver();
+    robots.clear();
+    shots.clear();
+    contacts.clear();
+    for (const std::shared_ptr<IRobot>& robot : engine.GetRobots())
+    {
+        SnapshotRobot entry{robot->GetX(), robot->GetY(), robot->GetFacing(), robot->GetScanDir(),
+                            robot->GetResolution(), robot->GetDamage(), static_cast<uint32_t>(contacts.size()), 0};
+        for (const ContactDetails& contact : robot->GetContacts())
+        {
+            contacts.push_back({contact.m_fromx, contact.m_fromy, contact.m_tox, contact.m_toy});
+            entry.contactCount++;
+        }
+        robots.push_back(entry);
+    }
+    const ShotPool& pool = engine.GetShots();
+    for (uint32_t i = 0; i < pool.GetCount(); i++)
+    {
+        shots.push_back({pool.m_currentX[i], pool.m_currentY[i], pool.m_facing[i]});
+    }
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Crobots
+{
+
+class Engine;
+
+struct SnapshotRobot
+{
+    float x;
+    float y;
+    float facing;
+    float scanDir;
+    float resolution;
+    float damage;
+    // Range of this robot's contacts in Snapshot::contacts.
+    uint32_t firstContact;
+    uint32_t contactCount;
+};
+
+struct SnapshotShot
+{
+    float x;
+    float y;
+    float facing;
+};
+
+struct SnapshotContact
+{
+    float fromX;
+    float fromY;
+    float toX;
+    float toY;
+};
+
+// A copy of what the renderer needs from the engine after a tick. The entries are plain
+// data; the vectors keep their capacity when a snapshot is refilled.
+struct Snapshot
+{
+    uint64_t tick;
+    uint32_t arenaX;
+    uint32_t arenaY;
+    bool debug;
+    bool gameOver;
+    std::vector<SnapshotRobot> robots;
+    std::vector<SnapshotShot> shots;
+    std::vector<SnapshotContact> contacts;
+
+    void Capture(const Engine& engine);
+};
+
+}
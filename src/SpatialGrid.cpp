@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "SpatialGrid.hpp"
+
+namespace
+{
+
+// Cells are never smaller than this, in meters.
+static constexpr float MinCellSize = 4.0f;
+// Average number of entries we aim for in each cell.
+static constexpr float EntriesPerCell = 2.0f;
+// Cones are widened by this much, in degrees, and cell extents by this fraction of a
+// cell, so that floating point error can only ever add candidates, never drop them.
+static constexpr double AngleSlack = 0.05;
+static constexpr double CellSlack = 1e-3;
+
+struct Point
+{
+    double x;
+    double y;
+};
+
+// Clip a convex polygon against the half-plane a * x + b * y <= c.
+uint32_t Clip(const Point* in, uint32_t count, Point* out, double a, double b, double c)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Point& p = in[i];
+        const Point& q = in[(i + 1) % count];
+        double dp = a * p.x + b * p.y - c;
+        double dq = a * q.x + b * q.y - c;
+        if (dp <= 0)
+        {
+            out[n++] = p;
+        }
+        if ((dp < 0 && dq > 0) || (dp > 0 && dq < 0))
+        {
+            double t = dp / (dp - dq);
+            out[n++] = {p.x + t * (q.x - p.x), p.y + t * (q.y - p.y)};
+        }
+    }
+    return n;
+}
+
+}
+
+namespace Crobots
+{
+
+SpatialGrid::SpatialGrid()
+    : m_width{0}
+    , m_height{0}
+    , m_cellSize{MinCellSize}
+    , m_columns{0}
+    , m_rows{0}
+{}
+
+void SpatialGrid::Init(float width, float height, uint32_t count)
+{
+    m_width = width;
+    m_height = height;
+    float area = std::max(1.0f, width * height);
+    m_cellSize = std::max(MinCellSize, std::sqrt(area * EntriesPerCell / std::max(1u, count)));
+    m_columns = static_cast<uint32_t>(width / m_cellSize) + 1;
+    m_rows = static_cast<uint32_t>(height / m_cellSize) + 1;
+    m_cells.resize(m_columns * m_rows);
+    for (std::vector<uint32_t>& cell : m_cells)
+    {
+        cell.clear();
+    }
+    m_cellOf.assign(count, Invalid);
+    m_slotOf.assign(count, Invalid);
+}
+
+uint32_t SpatialGrid::CellOf(float x, float y) const
+{
+    int32_t column = static_cast<int32_t>(std::floor(x / m_cellSize));
+    int32_t row = static_cast<int32_t>(std::floor(y / m_cellSize));
+    column = std::clamp<int32_t>(column, 0, m_columns - 1);
+    row = std::clamp<int32_t>(row, 0, m_rows - 1);
+    return row * m_columns + column;
+}
+
+void SpatialGrid::Update(uint32_t index, float x, float y)
+{
+    uint32_t cell = CellOf(x, y);
+    uint32_t old = m_cellOf[index];
+    if (cell == old)
+    {
+        return;
+    }
+    if (old != Invalid)
+    {
+        // Swap-remove from the old cell, fixing up the slot of the entry we moved.
+        std::vector<uint32_t>& entries = m_cells[old];
+        uint32_t slot = m_slotOf[index];
+        entries[slot] = entries.back();
+        m_slotOf[entries[slot]] = slot;
+        entries.pop_back();
+    }
+    m_cellOf[index] = cell;
+    m_slotOf[index] = m_cells[cell].size();
+    m_cells[cell].push_back(index);
+}
+
+void SpatialGrid::QueryCone(double x, double y, double lo, double hi, std::vector<uint32_t>& out) const
+{
+    // Split into pieces of at most 90 degrees so each one is a narrow convex cone.
+    lo -= AngleSlack;
+    hi += AngleSlack;
+    while (lo < hi)
+    {
+        double end = std::min(hi, lo + 90.0);
+        QueryConvexCone(x, y, lo, end, out);
+        lo = end;
+    }
+}
+
+void SpatialGrid::QueryConvexCone(double x, double y, double lo, double hi, std::vector<uint32_t>& out) const
+{
+    // Build a triangle that covers the cone out past the far corner of the arena, then clip
+    // it to the arena. Each row of cells is then visited between the polygon's x extents.
+    double reach = 2.0 * (std::hypot(m_width, m_height) + m_cellSize);
+    double a = lo * std::numbers::pi / 180.0;
+    double b = hi * std::numbers::pi / 180.0;
+    Point polygon[8];
+    Point scratch[8];
+    polygon[0] = {x, y};
+    polygon[1] = {x + reach * std::cos(a), y + reach * std::sin(a)};
+    polygon[2] = {x + reach * std::cos(b), y + reach * std::sin(b)};
+    uint32_t count = 3;
+    double margin = m_cellSize * CellSlack;
+    count = Clip(polygon, count, scratch, -1.0, 0.0, margin);
+    count = Clip(scratch, count, polygon, 1.0, 0.0, m_width + margin);
+    count = Clip(polygon, count, scratch, 0.0, -1.0, margin);
+    count = Clip(scratch, count, polygon, 0.0, 1.0, m_height + margin);
+    if (count == 0)
+    {
+        return;
+    }
+
+    double minY = polygon[0].y;
+    double maxY = polygon[0].y;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        minY = std::min(minY, polygon[i].y);
+        maxY = std::max(maxY, polygon[i].y);
+    }
+    int32_t firstRow = std::max<int32_t>(0, std::floor((minY - margin) / m_cellSize));
+    int32_t lastRow = std::min<int32_t>(m_rows - 1, std::floor((maxY + margin) / m_cellSize));
+    for (int32_t row = firstRow; row <= lastRow; row++)
+    {
+        double top = row * m_cellSize - margin;
+        double bottom = (row + 1) * m_cellSize + margin;
+        double minX = INFINITY;
+        double maxX = -INFINITY;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const Point& p = polygon[i];
+            const Point& q = polygon[(i + 1) % count];
+            if (p.y >= top && p.y <= bottom)
+            {
+                minX = std::min(minX, p.x);
+                maxX = std::max(maxX, p.x);
+            }
+            for (double line : {top, bottom})
+            {
+                if ((p.y < line && q.y > line) || (p.y > line && q.y < line))
+                {
+                    double ex = p.x + (line - p.y) / (q.y - p.y) * (q.x - p.x);
+                    minX = std::min(minX, ex);
+                    maxX = std::max(maxX, ex);
+                }
+            }
+        }
+        if (minX > maxX)
+        {
+            continue;
+        }
+        int32_t firstColumn = std::max<int32_t>(0, std::floor((minX - margin) / m_cellSize));
+        int32_t lastColumn = std::min<int32_t>(m_columns - 1, std::floor((maxX + margin) / m_cellSize));
+        for (int32_t column = firstColumn; column <= lastColumn; column++)
+        {
+            const std::vector<uint32_t>& entries = m_cells[row * m_columns + column];
+            out.insert(out.end(), entries.begin(), entries.end());
+        }
+    }
+}
+
+float SpatialGrid::GetCellSize() const
+{
+    return m_cellSize;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Crobots
+{
+
+// A uniform grid over the arena used to answer proximity queries without visiting every
+// robot. Entries are identified by their robot index and moved between cells only when
+// their cell changes. The cell size is picked from the arena area and entry count, and
+// grows for huge arenas so the cell array stays proportional to the number of robots.
+class SpatialGrid
+{
+public:
+    SpatialGrid();
+
+    // Size the grid for an arena and a number of entries, and empty it.
+    void Init(float width, float height, uint32_t count);
+    // Insert or move an entry.
+    void Update(uint32_t index, float x, float y);
+    // Append to out every entry whose cell overlaps the cone with apex (x, y) spanning the
+    // directions from lo to hi degrees (counter-clockwise, 0 to the right). The result is
+    // a superset of the entries inside the cone; callers apply the exact test. An entry may
+    // be appended more than once. Queries do not touch the grid, so any number of threads
+    // can run them at once.
+    void QueryCone(double x, double y, double lo, double hi, std::vector<uint32_t>& out) const;
+    float GetCellSize() const;
+
+private:
+    static constexpr uint32_t Invalid = 0xFFFFFFFF;
+
+    uint32_t CellOf(float x, float y) const;
+    void QueryConvexCone(double x, double y, double lo, double hi, std::vector<uint32_t>& out) const;
+
+    float m_width;
+    float m_height;
+    float m_cellSize;
+    uint32_t m_columns;
+    uint32_t m_rows;
+    std::vector<std::vector<uint32_t>> m_cells;
+    // For each entry, its cell and its position within that cell.
+    std::vector<uint32_t> m_cellOf;
+    std::vector<uint32_t> m_slotOf;
+};
+
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+
+#include "SweepAndPrune.hpp"
+
+namespace Crobots
+{
+
+void SweepAndPrune::Resize(uint32_t count)
+{
+    m_order.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_order[i] = i;
+    }
+}
+
+uint32_t SweepAndPrune::FindPairs(const float* x, const float* y, float radius,
+                              std::vector<std::pair<uint32_t, uint32_t>>& pairs)
+{
+    pairs.clear();
+    uint32_t count = m_order.size();
+    // Insertion sort: each entry only walks back past the few it overtook since last tick.
+    for (uint32_t i = 1; i < count; i++)
+    {
+        uint32_t entry = m_order[i];
+        float key = x[entry];
+        uint32_t j = i;
+        for (; j > 0 && x[m_order[j - 1]] > key; j--)
+        {
+            m_order[j] = m_order[j - 1];
+        }
+        m_order[j] = entry;
+    }
+    float reach = 2 * radius;
+    float reach2 = reach * reach;
+    uint32_t tests = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t a = m_order[i];
+        for (uint32_t j = i + 1; j < count; j++)
+        {
+            uint32_t b = m_order[j];
+            float dx = x[b] - x[a];
+            if (dx > reach)
+            {
+                break;
+            }
+            float dy = y[b] - y[a];
+            tests++;
+            if (dx * dx + dy * dy < reach2)
+            {
+                pairs.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return tests;
+}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Crobots
+{
+
+// Finds every pair of overlapping circles. Entries are kept sorted by X between calls;
+// they only move a little per tick, so the insertion sort that restores the order is close
+// to linear. A sweep then only compares entries whose X extents overlap, and the pairs that
+// survive get the exact circle test.
+class SweepAndPrune
+{
+public:
+    // Track count entries, identified by index.
+    void Resize(uint32_t count);
+    // Replace pairs with every (a, b), a < b, whose circles of the given radius around
+    // (x[a], y[a]) and (x[b], y[b]) overlap, sorted. Returns how many pairs got the exact
+    // circle test.
+    uint32_t FindPairs(const float* x, const float* y, float radius,
+                   std::vector<std::pair<uint32_t, uint32_t>>& pairs);
+
+private:
+    // Entry indices, sorted by X as of the last call.
+    std::vector<uint32_t> m_order;
+};
+
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <format>
+#include <thread>
+
+#include "TaskPool.hpp"
+#include "Trace.hpp"
+
+namespace Crobots
+{
+
+TaskPool::TaskPool(uint32_t threads)
+    : m_queued{0}
+    , m_pending{0}
+    , m_next{0}
+    , m_stop{false}
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (uint32_t i = 0; i < threads; i++)
+    {
+        m_threads.emplace_back(&TaskPool::Worker, this, i);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workCv.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void TaskPool::Submit(Task task)
+{
+    // Spread submissions round-robin; stealing evens out whatever imbalance is left.
+    uint32_t index = m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    m_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    m_workCv.notify_one();
+}
+
+void TaskPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [this] { return m_pending.load() == 0; });
+}
+
+uint32_t TaskPool::GetThreadCount() const
+{
+    return m_threads.size();
+}
+
+bool TaskPool::Pop(uint32_t index, Task& task)
+{
+    Queue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool TaskPool::Steal(uint32_t index, Task& task)
+{
+    for (uint32_t i = 1; i < m_queues.size(); i++)
+    {
+        Queue& queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::Worker(uint32_t index)
+{
+    TraceRecorder::SetThreadName(std::format("worker {}", index));
+    while (true)
+    {
+        Task task;
+        if (Pop(index, task) || Steal(index, task))
+        {
+            m_queued.fetch_sub(1);
+            task();
+            if (m_pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_idleCv.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workCv.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Crobots
+{
+
+// A fixed pool of worker threads, each with its own task deque. A worker pops its own
+// deque from the back and, when that runs dry, steals from the front of the others, so
+// a few long running tasks never leave the remaining cores idle.
+class TaskPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses one worker per hardware thread.
+    explicit TaskPool(uint32_t threads = 0);
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    ~TaskPool();
+
+    void Submit(Task task);
+    // Block until every submitted task has finished.
+    void Wait();
+    uint32_t GetThreadCount() const;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Worker(uint32_t index);
+    bool Pop(uint32_t index, Task& task);
+    bool Steal(uint32_t index, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_idleCv;
+    // Tasks sitting in a deque, and tasks submitted but not yet finished.
+    std::atomic<uint32_t> m_queued;
+    std::atomic<uint32_t> m_pending;
+    std::atomic<uint32_t> m_next;
+    bool m_stop;
+};
+
+}
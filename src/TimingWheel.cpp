@@ -0,0 +1,91 @@
+#include "TimingWheel.hpp"
+
+namespace Crobots
+{
+
+void TimingWheel::Reset(uint64_t tick)
+{
+    for (std::array<std::vector<Event>, SlotCount>& level : m_levels)
+    {
+        for (std::vector<Event>& slot : level)
+        {
+            slot.clear();
+        }
+    }
+    m_overflow.clear();
+    m_tick = tick;
+    m_pending = 0;
+}
+
+void TimingWheel::Schedule(uint64_t tick, uint32_t payload)
+{
+    File({tick < m_tick ? m_tick : tick, payload});
+    m_pending++;
+}
+
+void TimingWheel::File(const Event& event)
+{
+    // Level n covers the ticks that are less than 64^(n+1) away, in slots of 64^n ticks.
+    uint64_t delta = event.tick - m_tick;
+    for (uint32_t level = 0; level < LevelCount; level++)
+    {
+        if (delta < (uint64_t{1} << (LevelBits * (level + 1))))
+        {
+            uint32_t slot = (event.tick >> (LevelBits * level)) & (SlotCount - 1);
+            m_levels[level][slot].push_back(event);
+            return;
+        }
+    }
+    m_overflow.push_back(event);
+}
+
+void TimingWheel::Cascade(std::vector<Event>& slot)
+{
+    // Refile against the current tick; everything lands at least one level lower. Copied
+    // rather than swapped out, so every slot keeps its own capacity from match to match.
+    m_cascade.assign(slot.begin(), slot.end());
+    slot.clear();
+    for (const Event& event : m_cascade)
+    {
+        File(event);
+    }
+    m_cascade.clear();
+}
+
+void TimingWheel::Collect(std::vector<uint32_t>& due)
+{
+    std::vector<Event>& slot = m_levels[0][m_tick & (SlotCount - 1)];
+    for (const Event& event : slot)
+    {
+        due.push_back(event.payload);
+    }
+    m_pending -= slot.size();
+    slot.clear();
+
+    m_tick++;
+    // Whenever a level wraps, the next slot of the level above comes into its range.
+    for (uint32_t level = 1; level < LevelCount; level++)
+    {
+        if ((m_tick & ((uint64_t{1} << (LevelBits * level)) - 1)) != 0)
+        {
+            return;
+        }
+        Cascade(m_levels[level][(m_tick >> (LevelBits * level)) & (SlotCount - 1)]);
+    }
+    if ((m_tick & ((uint64_t{1} << (LevelBits * LevelCount)) - 1)) == 0)
+    {
+        Cascade(m_overflow);
+    }
+}
+
+uint64_t TimingWheel::GetTick() const
+{
+    return m_tick;
+}
+
+uint32_t TimingWheel::GetPendingCount() const
+{
+    return m_pending;
+}
+
+}
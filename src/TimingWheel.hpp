@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Crobots
+{
+
+// A hierarchical timing wheel: events are filed by the tick they are due on, and each
+// tick only looks at the events due on it. The first level holds one slot per tick for
+// the next 64 ticks, each further level slots 64 times coarser and is cascaded down a
+// level as its slots come into range. Events beyond the last level wait in an overflow
+// list. Scheduling and collecting are O(1) per event however many events are pending.
+class TimingWheel
+{
+public:
+    // Drop every pending event and start counting at tick.
+    void Reset(uint64_t tick);
+    // Schedule payload for tick; ticks already passed are due on the current tick.
+    void Schedule(uint64_t tick, uint32_t payload);
+    // Append the payloads due on the current tick to due, then move on to the next tick.
+    void Collect(std::vector<uint32_t>& due);
+    uint64_t GetTick() const;
+    uint32_t GetPendingCount() const;
+
+private:
+    static constexpr uint32_t LevelBits = 6;
+    static constexpr uint32_t SlotCount = 1 << LevelBits;
+    static constexpr uint32_t LevelCount = 4;
+
+    struct Event
+    {
+        uint64_t tick;
+        uint32_t payload;
+    };
+
+    void File(const Event& event);
+    void Cascade(std::vector<Event>& slot);
+
+    uint64_t m_tick{0};
+    uint32_t m_pending{0};
+    std::array<std::array<std::vector<Event>, SlotCount>, LevelCount> m_levels;
+    std::vector<Event> m_overflow;
+    std::vector<Event> m_cascade;
+};
+
+}
@@ -0,0 +1,180 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "json.hpp"
+
+#include "Api.hpp"
+#include "CpuBudget.hpp"
+#include "Engine.hpp"
+#include "Loader.hpp"
+#include "Replay.hpp"
+#include "TaskPool.hpp"
+#include "Tournament.hpp"
+
+namespace
+{
+
+// Matches that nobody wins still have to end.
+static constexpr uint64_t DefaultMaxTicks = 10000;
+
+}
+
+namespace Crobots
+{
+
+Tournament::Tournament()
+    : m_info{}
+{}
+
+bool Tournament::Init(const AppInfo& info)
+{
+    m_info = info;
+    if (m_info.maxTicks == 0)
+    {
+        m_info.maxTicks = DefaultMaxTicks;
+    }
+    if (!m_info.replay.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_info.replay, error);
+        if (error)
+        {
+            std::cerr << "Cannot create replay directory " << m_info.replay << ": " << error.message() << std::endl;
+            return false;
+        }
+    }
+    if (m_info.robots.size() < 2)
+    {
+        std::cerr << "A tournament needs at least two robots" << std::endl;
+        return false;
+    }
+    for (const std::string& name : m_info.robots)
+    {
+        RobotFactory factory = Loader::LoadModule(name);
+        if (!factory)
+        {
+            std::cerr << "Failed to load " << name << std::endl;
+            return false;
+        }
+        m_names.push_back(name);
+        m_modules.push_back(std::move(factory));
+        m_standings.push_back({0, 0, 0});
+    }
+    uint64_t seed = m_info.seed;
+    for (uint32_t round = 0; round < m_info.rounds; round++)
+    for (uint32_t i = 0; i < m_modules.size(); i++)
+    for (uint32_t j = i + 1; j < m_modules.size(); j++)
+    {
+        uint32_t index = m_matches.size();
+        m_matches.push_back({index, i, j, seed + index});
+    }
+    CROBOTS_LOG_INFO(Engine, "Tournament: {} robots, {} matches", m_modules.size(), m_matches.size());
+    return true;
+}
+
+int Tournament::Run()
+{
+    auto start = std::chrono::steady_clock::now();
+    {
+        TaskPool pool(m_info.threads);
+        for (const Match& match : m_matches)
+        {
+            pool.Submit([this, &match] { Play(match); });
+        }
+        pool.Wait();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    nlohmann::json summary;
+    summary["matches"] = m_matches.size();
+    summary["elapsed_seconds"] = std::chrono::duration<double>(end - start).count();
+    nlohmann::json standings = nlohmann::json::array();
+    for (uint32_t i = 0; i < m_names.size(); i++)
+    {
+        nlohmann::json entry;
+        entry["name"] = m_names[i];
+        entry["wins"] = m_standings[i].wins;
+        entry["losses"] = m_standings[i].losses;
+        entry["draws"] = m_standings[i].draws;
+        standings.push_back(entry);
+    }
+    summary["standings"] = standings;
+    nlohmann::json result;
+    result["summary"] = summary;
+    std::cout << result.dump() << std::endl;
+    return 0;
+}
+
+void Tournament::Play(const Match& match)
+{
+    std::shared_ptr<Engine> engine = std::make_shared<Engine>();
+    engine->Init(Arena(m_info.arenaX, m_info.arenaY), false, m_info.damage, false, match.seed);
+    engine->SetBruteForceScan(m_info.bruteForceScan);
+    engine->SetCpuBudget(m_info.cpuBudget);
+    engine->SetSandbox(m_info.sandbox);
+    Loader loader(engine);
+    loader.Create(m_modules[match.robot1], 0);
+    loader.Create(m_modules[match.robot2], 1);
+    engine->Load(loader.GetRobots());
+    ReplayRecorder recorder;
+    std::string replay;
+    if (!m_info.replay.empty())
+    {
+        replay = (std::filesystem::path(m_info.replay) / std::format("match-{}.replay", match.index)).string();
+        if (recorder.Start(replay, *engine))
+        {
+            engine->SetRecorder(&recorder);
+        }
+        else
+        {
+            CROBOTS_LOG_ERROR(Engine, "Failed to open replay {}", replay);
+            replay.clear();
+        }
+    }
+    while (!engine->IsGameOver() && engine->GetTick() < m_info.maxTicks)
+    {
+        engine->Tick();
+    }
+
+    // Exactly one robot standing wins, anything else is a draw.
+    const std::vector<std::shared_ptr<IRobot>>& robots = engine->GetRobots();
+    int32_t winner = -1;
+    if (engine->GetAliveCount() == 1)
+    {
+        winner = robots[0]->GetDamage() < 100 ? 0 : 1;
+    }
+    nlohmann::json result;
+    result["match"] = match.index;
+    result["seed"] = match.seed;
+    result["ticks"] = engine->GetTick();
+    result["robots"] = {m_names[match.robot1], m_names[match.robot2]};
+    result["damage"] = {robots[0]->GetDamage(), robots[1]->GetDamage()};
+    result["tick_cost"] = {TickCostJson(engine->GetCpu(0)), TickCostJson(engine->GetCpu(1))};
+    result["winner"] = winner < 0 ? nlohmann::json(nullptr) : nlohmann::json(winner == 0 ? m_names[match.robot1] : m_names[match.robot2]);
+    engine->SetRecorder(nullptr);
+    recorder.Finish();
+    if (!replay.empty())
+    {
+        result["replay"] = replay;
+    }
+    engine->Unload();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (winner < 0)
+    {
+        m_standings[match.robot1].draws++;
+        m_standings[match.robot2].draws++;
+    }
+    else
+    {
+        m_standings[winner == 0 ? match.robot1 : match.robot2].wins++;
+        m_standings[winner == 0 ? match.robot2 : match.robot1].losses++;
+    }
+    std::cout << result.dump() << std::endl;
+}
+
+}
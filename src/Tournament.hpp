@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Api.hpp"
+#include "Loader.hpp"
+
+namespace Crobots
+{
+
+// Round-robin tournament runner. Every robot module is loaded once, then each pairing is
+// played as an independent headless match on a work-stealing pool. One JSON line is
+// written to stdout per match as it finishes, followed by a summary line.
+class Tournament
+{
+public:
+    Tournament();
+    bool Init(const AppInfo& info);
+    int Run();
+
+private:
+    struct Match
+    {
+        uint32_t index;
+        uint32_t robot1;
+        uint32_t robot2;
+        uint64_t seed;
+    };
+
+    struct Standing
+    {
+        uint32_t wins;
+        uint32_t losses;
+        uint32_t draws;
+    };
+
+    void Play(const Match& match);
+
+    AppInfo m_info;
+    std::vector<std::string> m_names;
+    std::vector<RobotFactory> m_modules;
+    std::vector<Match> m_matches;
+    std::vector<Standing> m_standings;
+    std::mutex m_mutex;
+};
+
+}
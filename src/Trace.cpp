@@ -0,0 +1,234 @@
+#include <array>
+#include <format>
+#include <fstream>
+
+#include "Crobots++/Log.hpp"
+#include "Profiler.hpp"
+#include "Trace.hpp"
+
+namespace Crobots
+{
+
+namespace
+{
+
+// Events are stored in chunks that never move, so a buffer grows without copying.
+constexpr uint32_t ChunkSize = 4096;
+
+thread_local std::string t_threadName;
+
+}
+
+struct TraceRecorder::Event
+{
+    uint64_t start;
+    uint64_t end;
+    const char* name;
+    const char* category;
+    uint32_t arg;
+    // Chrome trace phase: X (complete), B, E or i (instant).
+    char type;
+};
+
+struct TraceRecorder::ThreadBuffer
+{
+    uint32_t tid;
+    std::string name;
+    std::vector<std::unique_ptr<std::array<Event, ChunkSize>>> chunks;
+    uint64_t count{0};
+};
+
+namespace
+{
+
+thread_local void* t_buffer = nullptr;
+thread_local uint64_t t_generation = 0;
+
+}
+
+TraceRecorder::TraceRecorder()
+: m_recording{false}
+, m_generation{0}
+, m_startCycles{0}
+, m_startNs{0}
+, m_nsPerCycle{1.0}
+{}
+
+TraceRecorder::~TraceRecorder() = default;
+
+TraceRecorder& TraceRecorder::Get()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::Start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.clear();
+    m_generation.fetch_add(1);
+    m_startCycles = ReadCycles();
+    m_startNs = SteadyNanoseconds();
+    m_recording.store(true);
+}
+
+void TraceRecorder::Stop()
+{
+    m_recording.store(false);
+    uint64_t cycles = ReadCycles() - m_startCycles;
+    uint64_t ns = SteadyNanoseconds() - m_startNs;
+    m_nsPerCycle = cycles > 0 ? static_cast<double>(ns) / cycles : 1.0;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::Register()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = m_buffers.size() + 1;
+    buffer->name = t_threadName.empty() ? std::format("thread {}", buffer->tid) : t_threadName;
+    t_buffer = buffer.get();
+    t_generation = m_generation.load();
+    m_buffers.push_back(std::move(buffer));
+    return static_cast<ThreadBuffer*>(t_buffer);
+}
+
+void TraceRecorder::Add(const Event& event)
+{
+    ThreadBuffer* buffer = static_cast<ThreadBuffer*>(t_buffer);
+    if (t_generation != m_generation.load(std::memory_order_relaxed))
+    {
+        buffer = Register();
+    }
+    uint32_t slot = buffer->count % ChunkSize;
+    if (slot == 0)
+    {
+        buffer->chunks.push_back(std::make_unique<std::array<Event, ChunkSize>>());
+    }
+    (*buffer->chunks.back())[slot] = event;
+    buffer->count++;
+}
+
+void TraceRecorder::Complete(const char* name, const char* category, uint64_t start, uint64_t end, uint32_t arg)
+{
+    if (IsRecording())
+    {
+        Add({start, end, name, category, arg, 'X'});
+    }
+}
+
+void TraceRecorder::Begin(const char* name, const char* category)
+{
+    if (IsRecording())
+    {
+        Add({ReadCycles(), 0, name, category, NoArg, 'B'});
+    }
+}
+
+void TraceRecorder::End(const char* name, const char* category)
+{
+    if (IsRecording())
+    {
+        Add({ReadCycles(), 0, name, category, NoArg, 'E'});
+    }
+}
+
+void TraceRecorder::Instant(const char* name, const char* category, uint32_t arg)
+{
+    if (IsRecording())
+    {
+        Add({ReadCycles(), 0, name, category, arg, 'i'});
+    }
+}
+
+void TraceRecorder::SetThreadName(const std::string& name)
+{
+    t_threadName = name;
+}
+
+uint64_t TraceRecorder::GetEventCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t count = 0;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : m_buffers)
+    {
+        count += buffer->count;
+    }
+    return count;
+}
+
+bool TraceRecorder::Write(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        CROBOTS_LOG_ERROR(Engine, "Cannot open trace {}", path);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Microseconds since Start, which is what the format expects.
+    auto us = [this](uint64_t cycles)
+    {
+        return (static_cast<double>(cycles) - static_cast<double>(m_startCycles)) * m_nsPerCycle / 1000.0;
+    };
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : m_buffers)
+    {
+        std::string name;
+        for (char c : buffer->name)
+        {
+            if (c == '"' || c == '\\')
+            {
+                name += '\\';
+            }
+            name += c;
+        }
+        file << (first ? "" : ",") << std::format("\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},"
+                                                  "\"args\":{{\"name\":\"{}\"}}}}", buffer->tid, name);
+        first = false;
+        for (uint64_t i = 0; i < buffer->count; i++)
+        {
+            const Event& event = (*buffer->chunks[i / ChunkSize])[i % ChunkSize];
+            file << std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}",
+                                event.name, event.category, event.type, buffer->tid, us(event.start));
+            if (event.type == 'X')
+            {
+                file << std::format(",\"dur\":{:.3f}", (event.end - event.start) * m_nsPerCycle / 1000.0);
+            }
+            else if (event.type == 'i')
+            {
+                file << ",\"s\":\"t\"";
+            }
+            if (event.arg != NoArg)
+            {
+                file << std::format(",\"args\":{{\"id\":{}}}", event.arg);
+            }
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+TraceScope::TraceScope(const char* name, const char* category, uint32_t arg)
+: m_name{name}
+, m_category{category}
+, m_arg{arg}
+, m_start{0}
+, m_recording{TraceRecorder::Get().IsRecording()}
+{
+    if (m_recording)
+    {
+        m_start = ReadCycles();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (m_recording)
+    {
+        TraceRecorder::Get().Complete(m_name, m_category, m_start, ReadCycles(), m_arg);
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Crobots
+{
+
+// Hands the latest of a stream of values from one writer thread to one reader thread
+// without locks or waiting. The writer fills its private buffer and publishes it by
+// swapping it with the shared middle buffer; the reader swaps the middle buffer for its
+// own when a newer one is there. Neither side ever sees a buffer the other is using.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : m_middle{1}
+        , m_write{0}
+        , m_read{2}
+    {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side: fill this, then Publish().
+    T& GetWriteBuffer()
+    {
+        return m_buffers[m_write];
+    }
+
+    void Publish()
+    {
+        m_write = m_middle.exchange(m_write | Fresh, std::memory_order_acq_rel) & Index;
+    }
+
+    // Reader side: the newest published value, valid until the next call.
+    const T& Acquire()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & Fresh)
+        {
+            m_read = m_middle.exchange(m_read, std::memory_order_acq_rel) & Index;
+        }
+        return m_buffers[m_read];
+    }
+
+private:
+    static constexpr uint8_t Index = 3;
+    static constexpr uint8_t Fresh = 4;
+
+    T m_buffers[3];
+    // Index of the middle buffer, with Fresh set when the reader has not taken it yet.
+    std::atomic<uint8_t> m_middle;
+    uint8_t m_write;
+    uint8_t m_read;
+};
+
+}
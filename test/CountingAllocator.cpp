@@ -0,0 +1,43 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "CountingAllocator.hpp"
+
+namespace
+{
+
+std::atomic<uint64_t> g_allocations{0};
+
+}
+
+// Count every allocation. The array, nothrow and sized forms all end up here.
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace Crobots::Test
+{
+
+uint64_t GetAllocationCount()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Linking CountingAllocator.cpp into a program replaces its operator new with one that
+// counts, so tests and benchmarks can check what a piece of code allocates.
+
+namespace Crobots::Test
+{
+
+// Every allocation made by the process so far.
+uint64_t GetAllocationCount();
+
+}
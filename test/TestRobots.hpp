@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Crobots++/IRobot.hpp"
+#include "src/Arena.hpp"
+#include "src/Engine.hpp"
+
+// Robots and engine setup shared by the tests and the benchmarks.
+
+namespace Crobots::Test
+{
+
+// Sits still, so all that is measured is the engine.
+class Idle : public IRobot
+{
+public:
+    std::string_view GetName() const override { return "idle"; }
+    void Tick() override {}
+};
+
+// Scans, fires and steers by what it sees, including whether it was scanned itself.
+class Brawler : public IRobot
+{
+public:
+    std::string_view GetName() const override { return "brawler"; }
+    void Tick() override
+    {
+        m_dir = m_dir + (IsDetected() ? 31 : 13);
+        float range = Scan(m_dir, 20);
+        if (range > 0)
+        {
+            Cannon(m_dir, range);
+            Drive(m_dir, 40);
+        }
+        else
+        {
+            Drive(Rand(360), 70);
+        }
+    }
+
+private:
+    float m_dir = 0;
+};
+
+// Sweeps its scanner round, fires at whatever it finds and drives somewhere new every tick.
+class Gunner : public IRobot
+{
+public:
+    std::string_view GetName() const override { return "gunner"; }
+    void Tick() override
+    {
+        m_ticks++;
+        m_dir = Mod360(m_dir + 23);
+        float range = Scan(m_dir, 10);
+        if (range > 0)
+        {
+            Cannon(m_dir, range);
+        }
+        Drive(Rand(360), 40);
+    }
+    uint64_t m_ticks = 0;
+
+private:
+    float m_dir = 0;
+};
+
+// Sweeps its scanner round and fires blind, counting the scans it made and what they found.
+class Sweeper : public IRobot
+{
+public:
+    std::string_view GetName() const override { return "sweeper"; }
+    void Tick() override
+    {
+        m_dir = Mod360(m_dir + 17);
+        bool ready = ScanReady();
+        if (Scan(m_dir, 10) > 0)
+        {
+            m_contacts++;
+        }
+        m_scans += ready ? 1 : 0;
+        Cannon(m_dir, 200);
+        Drive(Rand(360), 30);
+    }
+    uint64_t m_scans = 0;
+    uint64_t m_contacts = 0;
+
+private:
+    float m_dir = 0;
+};
+
+template<typename Robot>
+std::vector<std::shared_ptr<IRobot>> MakeRobots(Engine& engine, uint32_t count)
+{
+    std::vector<std::shared_ptr<IRobot>> robots;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        robots.emplace_back(IRobot::Create<Robot>(engine.GetProxy(i)));
+    }
+    return robots;
+}
+
+// A square arena with count robots loaded. Without damage the robots play on whatever hits them.
+template<typename Robot>
+std::shared_ptr<Engine> MakeEngine(uint32_t count, uint32_t size, uint64_t seed, bool damage = true)
+{
+    auto engine = std::make_shared<Engine>();
+    engine->Init(Arena(size, size), false, damage, false, seed);
+    engine->Load(MakeRobots<Robot>(*engine, count));
+    return engine;
+}
+
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <vector>
+
+#include "src/Blasts.hpp"
+
+// Resolve a few blasts against robots placed on and around each ring (more robots than one
+// SIMD block, so both the block and the tail path run) and check damage and kill credit.
+
+int main()
+{
+    Crobots::Blasts blasts;
+    blasts.Add(100.0f, 100.0f, 1.0f, 0.0f, 0.0f);
+    blasts.Add(100.0f, 100.0f, 0.0f, 1.0f, 90.0f);
+    blasts.Add(500.0f, 500.0f, 0.0f, 1.0f, 90.0f);
+
+    const float distances[] = {0.0f, 5.0f, 5.5f, 20.0f, 30.0f, 40.0f, 41.0f, 300.0f};
+    const float expected[] = {20.0f, 20.0f, 10.0f, 10.0f, 6.0f, 6.0f, 0.0f, 0.0f};
+    std::vector<float> x, y, damage;
+    for (uint32_t i = 0; i < 11; i++)
+    {
+        x.push_back(100.0f + distances[i % 8]);
+        y.push_back(100.0f);
+        damage.push_back(0.0f);
+    }
+    // Robot 8 is one blast from death, robot 9 already dead, robot 10 sits on the far blast.
+    damage[8] = 95.0f;
+    damage[9] = 100.0f;
+    x[10] = 500.0f;
+    y[10] = 500.0f;
+    std::vector<float> before = damage;
+    blasts.Resolve(x.data(), y.data(), damage.data(), x.size());
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        if (damage[i] != expected[i])
+        {
+            std::cerr << "robot " << i << " took " << damage[i] << ", expected " << expected[i] << std::endl;
+            return 1;
+        }
+    }
+    if (damage[8] != 100.0f || blasts.FindKiller(x[8], y[8], before[8]) != 0)
+    {
+        std::cerr << "robot 8 should die to the first blast" << std::endl;
+        return 1;
+    }
+    if (damage[9] != 100.0f || blasts.FindKiller(x[9], y[9], before[9]) != Crobots::Blasts::None)
+    {
+        std::cerr << "a dead robot was hit again" << std::endl;
+        return 1;
+    }
+    if (damage[10] != 10.0f)
+    {
+        std::cerr << "robot 10 took " << damage[10] << std::endl;
+        return 1;
+    }
+    return 0;
+}
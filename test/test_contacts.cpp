@@ -0,0 +1,62 @@
+#include <iostream>
+#include <memory>
+
+#include "test/CountingAllocator.hpp"
+#include "test/TestRobots.hpp"
+
+// Scan contacts are kept by value in a buffer the robot reuses every tick, so once the
+// buffers have seen a tick's contacts, scanning allocates nothing.
+
+int main()
+{
+    constexpr uint32_t Count = 32;
+    // A small arena, so every scan finds several robots.
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Crobots::Test::Idle>(Count, 20, 9);
+    const Crobots::IRobot& scanner = *engine->GetRobots()[0];
+
+    // Once round to size the buffers, then again counting allocations.
+    uint64_t allocations = 0;
+    uint32_t contacts = 0;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        uint64_t before = Crobots::Test::GetAllocationCount();
+        contacts = 0;
+        for (float dir = 0; dir < 360; dir += 10)
+        {
+            float range = engine->ScanResult(0, dir, 10);
+            std::span<const Crobots::ContactDetails> found = scanner.GetContacts();
+            if ((range > 0) != !found.empty())
+            {
+                std::cerr << "scan returned " << range << " with " << found.size() << " contacts" << std::endl;
+                return 1;
+            }
+            for (const Crobots::ContactDetails& contact : found)
+            {
+                if (contact.m_range <= 0 || contact.m_fromx != scanner.GetX() || contact.m_fromy != scanner.GetY())
+                {
+                    std::cerr << "bad contact: " << contact.ToString();
+                    return 1;
+                }
+            }
+            contacts += found.size();
+            engine->Tick();
+            if (!scanner.GetContacts().empty())
+            {
+                std::cerr << "contacts outlived the tick" << std::endl;
+                return 1;
+            }
+        }
+        allocations = Crobots::Test::GetAllocationCount() - before;
+    }
+    if (contacts < Count - 1)
+    {
+        std::cerr << "a full sweep found only " << contacts << " contacts" << std::endl;
+        return 1;
+    }
+    if (allocations != 0)
+    {
+        std::cerr << allocations << " allocations recording " << contacts << " contacts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Crobots++/ClassicRobot.hpp"
+#include "Crobots++/InternalRobotProxy.hpp"
+#include "src/Arena.hpp"
+#include "src/Coroutine.hpp"
+#include "src/Engine.hpp"
+
+// Coroutines pick up where they suspended, on any thread, and classic robots get exactly
+// their allowance of API calls per tick.
+
+namespace
+{
+
+// Counts the queries it gets to make each tick.
+class Looper : public Crobots::ClassicRobot
+{
+public:
+    std::string_view GetName() const override { return "looper"; }
+    void Run() override
+    {
+        for (;;)
+        {
+            LocX();
+            m_calls++;
+        }
+    }
+    uint32_t m_calls = 0;
+};
+
+// Scans as often as it can.
+class Scanner : public Crobots::ClassicRobot
+{
+public:
+    std::string_view GetName() const override { return "scanner"; }
+    void Run() override
+    {
+        for (;;)
+        {
+            Scan(0, 10);
+            m_scans++;
+        }
+    }
+    uint32_t m_scans = 0;
+};
+
+class Quitter : public Crobots::ClassicRobot
+{
+public:
+    std::string_view GetName() const override { return "quitter"; }
+    void Run() override
+    {
+        Drive(90, 30);
+        Drive(180, 30);
+    }
+};
+
+bool TestCoroutine()
+{
+    std::vector<int> trace;
+    Crobots::Coroutine* self = nullptr;
+    Crobots::Coroutine coroutine([&]
+    {
+        // Deep enough that locals must survive on the coroutine's own stack.
+        for (int i = 0; i < 3; i++)
+        {
+            trace.push_back(i);
+            self->Suspend();
+        }
+        throw std::runtime_error("done");
+    });
+    self = &coroutine;
+    coroutine.Resume();
+    trace.push_back(10);
+    std::thread([&] { coroutine.Resume(); }).join();
+    trace.push_back(11);
+    coroutine.Resume();
+    coroutine.Resume();
+    coroutine.Resume();
+    return coroutine.IsDone() && trace == std::vector<int>{0, 10, 1, 11, 2};
+}
+
+}
+
+int main()
+{
+    if (!TestCoroutine())
+    {
+        std::cerr << "coroutine did not resume where it left off" << std::endl;
+        return 1;
+    }
+
+    auto engine = std::make_shared<Crobots::Engine>();
+    engine->Init(Crobots::Arena(100, 100), false, true, false, 3);
+    auto looper = static_cast<Looper*>(Crobots::IRobot::Create<Looper>(engine->GetProxy(1)));
+    auto scanner = static_cast<Scanner*>(Crobots::IRobot::Create<Scanner>(engine->GetProxy(2)));
+    std::vector<std::shared_ptr<Crobots::IRobot>> robots{
+        std::shared_ptr<Crobots::IRobot>(Crobots::IRobot::Create<Quitter>(engine->GetProxy(0))),
+        std::shared_ptr<Crobots::IRobot>(looper),
+        std::shared_ptr<Crobots::IRobot>(scanner)};
+    engine->Load(std::move(robots));
+    for (uint32_t tick = 0; tick < 30; tick++)
+    {
+        engine->Tick();
+    }
+    // The scanner rests for two ticks after each scan.
+    const Crobots::RobotStates& states = engine->GetStates();
+    if (looper->m_calls != 30 * Crobots::ClassicRobot::CallsPerTick || scanner->m_scans != 10 ||
+        states.m_desiredFacing[0] != 180)
+    {
+        std::cerr << "classic robots got the wrong allowance: " << looper->m_calls << " calls, "
+                  << scanner->m_scans << " scans" << std::endl;
+        return 1;
+    }
+    engine->Unload();
+    return 0;
+}
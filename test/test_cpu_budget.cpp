@@ -0,0 +1,85 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "src/CpuBudget.hpp"
+#include "test/TestRobots.hpp"
+
+// Tick cost percentiles stay within a bucket of the truth, and a robot that blows its
+// budget is skipped or disqualified as configured.
+
+namespace
+{
+
+class Spinner : public Crobots::IRobot
+{
+public:
+    std::string_view GetName() const override { return "spinner"; }
+    void Tick() override
+    {
+        // Burn a couple of milliseconds of CPU.
+        uint64_t start = Crobots::ThreadCpuNanoseconds();
+        while (Crobots::ThreadCpuNanoseconds() - start < 2000000)
+        {
+        }
+        m_ticks++;
+    }
+    uint32_t m_ticks = 0;
+};
+
+std::shared_ptr<Crobots::Engine> Play(Crobots::BudgetPolicy policy, std::shared_ptr<Spinner>& spinner)
+{
+    auto engine = std::make_shared<Crobots::Engine>();
+    engine->Init(Crobots::Arena(100, 100), false, true, false, 5);
+    Crobots::CpuBudget budget;
+    budget.tickNs = 100000;
+    budget.policy = policy;
+    budget.skipTicks = 4;
+    engine->SetCpuBudget(budget);
+    spinner.reset(static_cast<Spinner*>(Crobots::IRobot::Create<Spinner>(engine->GetProxy(0))));
+    std::vector<std::shared_ptr<Crobots::IRobot>> robots{spinner,
+        std::shared_ptr<Crobots::IRobot>(Crobots::IRobot::Create<Crobots::Test::Idle>(engine->GetProxy(1)))};
+    engine->Load(std::move(robots));
+    for (uint32_t tick = 0; tick < 10; tick++)
+    {
+        engine->Tick();
+    }
+    return engine;
+}
+
+}
+
+int main()
+{
+    Crobots::CostHistogram histogram;
+    for (uint64_t ns = 1; ns <= 100000; ns++)
+    {
+        histogram.Add(ns);
+    }
+    uint64_t p50 = histogram.GetPercentile(0.5);
+    uint64_t p99 = histogram.GetPercentile(0.99);
+    if (p50 < 50000 || p50 > 50000 * 1.125 || p99 < 99000 || p99 > 100000 || histogram.GetMax() != 100000)
+    {
+        std::cerr << "percentiles off: p50 " << p50 << ", p99 " << p99 << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Spinner> spinner;
+    // Ticks 0 and 5 run; each overrun sits out the next four.
+    auto engine = Play(Crobots::BudgetPolicy::Skip, spinner);
+    if (spinner->m_ticks != 2 || engine->GetCpu(0).overruns != 2 || engine->GetCpu(1).overruns != 0)
+    {
+        std::cerr << "skip: spinner ticked " << spinner->m_ticks << " times" << std::endl;
+        return 1;
+    }
+    engine->Unload();
+    engine = Play(Crobots::BudgetPolicy::Disqualify, spinner);
+    if (spinner->m_ticks != 1 || !engine->GetCpu(0).disqualified ||
+        engine->GetRobots()[0]->GetDeathData().Type != Crobots::DamageType::Disqualified)
+    {
+        std::cerr << "disqualify: spinner ticked " << spinner->m_ticks << " times" << std::endl;
+        return 1;
+    }
+    engine->Unload();
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "test/CountingAllocator.hpp"
+#include "test/TestRobots.hpp"
+
+// A match takes any number of robots, and its per-tick buffers are sized for them when
+// they are loaded: the shot buffers are never reallocated however busy the match gets, and
+// scans that find every other robot fit in the scan and contact buffers.
+
+int main()
+{
+    constexpr uint32_t Count = 256;
+    // Log lines are formatted into strings; keep them out of the count.
+    Crobots::Internal::SetLogLevels("warn");
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Crobots::Test::Gunner>(Count, 1000, 11);
+    if (engine->GetStates().GetCount() != Count)
+    {
+        std::cerr << "the engine did not take every robot" << std::endl;
+        return 1;
+    }
+
+    // A scan half way round, from every robot at once.
+    uint64_t before = Crobots::Test::GetAllocationCount();
+    uint32_t widest = 0;
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        engine->ScanResult(i, 0, 180);
+        widest = std::max<uint32_t>(widest, engine->GetRobots()[i]->GetContacts().size());
+    }
+    uint64_t allocations = Crobots::Test::GetAllocationCount() - before;
+    if (widest < Count / 4 || allocations != 0)
+    {
+        std::cerr << allocations << " allocations for scans finding up to " << widest << " robots" << std::endl;
+        return 1;
+    }
+
+    const float* shots = engine->GetShots().m_currentX.data();
+    std::vector<const Crobots::ContactDetails*> contacts;
+    for (const std::shared_ptr<Crobots::IRobot>& robot : engine->GetRobots())
+    {
+        contacts.push_back(robot->GetContacts().data());
+    }
+    uint32_t busiest = 0;
+    for (uint32_t tick = 0; tick < 250 && !engine->IsGameOver(); tick++)
+    {
+        engine->Tick();
+        busiest = std::max(busiest, engine->GetShots().GetCount());
+        if (engine->GetShots().m_currentX.data() != shots)
+        {
+            std::cerr << "the shot buffers were reallocated on tick " << tick << std::endl;
+            return 1;
+        }
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            if (engine->GetRobots()[i]->GetContacts().data() != contacts[i])
+            {
+                std::cerr << "the contacts of robot " << i << " were reallocated on tick " << tick << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (busiest < Count / 10)
+    {
+        std::cerr << "only " << busiest << " shots were in flight at once" << std::endl;
+        return 1;
+    }
+    engine->Unload();
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "test/CountingAllocator.hpp"
+#include "test/TestRobots.hpp"
+
+// Reset starts a new match on the same engine with robots made again in place: a match
+// replayed with its seed plays out as it did the first time, and once the engine's
+// buffers have grown, whole matches run without a single allocation.
+
+int main()
+{
+    constexpr uint32_t Count = 6;
+    constexpr uint64_t MaxTicks = 3000;
+    // Log lines are formatted into strings; keep them out of the count.
+    Crobots::Internal::SetLogLevels("warn");
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Crobots::Test::Gunner>(Count, 60, 100);
+    const Crobots::IRobot* first = engine->GetRobots()[0].get();
+
+    Crobots::MatchResult reference = engine->RunMatch(MaxTicks);
+    if (!reference.gameOver || !reference.winner)
+    {
+        std::cerr << "the first match had no winner after " << reference.ticks << " ticks" << std::endl;
+        return 1;
+    }
+    std::vector<float> damage(engine->GetStates().m_damage);
+
+    for (uint64_t seed = 101; seed < 104; seed++)
+    {
+        engine->Reset(seed);
+        engine->RunMatch(MaxTicks);
+    }
+    uint64_t before = Crobots::Test::GetAllocationCount();
+    engine->Reset(100);
+    // A robot left over from the last match would not start from zero.
+    for (const std::shared_ptr<Crobots::IRobot>& robot : engine->GetRobots())
+    {
+        if (static_cast<const Crobots::Test::Gunner*>(robot.get())->m_ticks != 0)
+        {
+            std::cerr << "a robot kept its state across Reset" << std::endl;
+            return 1;
+        }
+    }
+    Crobots::MatchResult again = engine->RunMatch(MaxTicks);
+    uint64_t allocations = Crobots::Test::GetAllocationCount() - before;
+
+    if (engine->GetRobots()[0].get() != first)
+    {
+        std::cerr << "Reset did not make the robots again in place" << std::endl;
+        return 1;
+    }
+    if (again.ticks != reference.ticks || again.winner != reference.winner || engine->GetStates().m_damage != damage)
+    {
+        std::cerr << "the replayed match ended differently: " << again.ticks << " ticks against "
+                  << reference.ticks << std::endl;
+        return 1;
+    }
+    if (allocations != 0)
+    {
+        std::cerr << allocations << " allocations in a match on a reset engine" << std::endl;
+        return 1;
+    }
+    return 0;
+}
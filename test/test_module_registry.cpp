@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Crobots++/IRobot.hpp"
+#include "src/Arena.hpp"
+#include "src/Engine.hpp"
+#include "src/ModuleRegistry.hpp"
+
+// Every module is opened once however many robots are made from it, a module can hold
+// several robot classes, and a module is closed once nothing made from it is left.
+// Preloading the directory, which also holds other libraries, finds only the robots.
+
+namespace
+{
+
+// Counts the errors logged while it is the sink.
+class ErrorCounter : public Crobots::Internal::LogSink
+{
+public:
+    uint32_t RegisterSite(Crobots::LogLevel level, Crobots::LogCategory, std::string_view, uint32_t,
+                          std::string_view, std::string_view) override
+    {
+        m_levels.push_back(level);
+        return m_levels.size() - 1;
+    }
+    void WriteEvent(uint32_t site, const char*, uint32_t) override
+    {
+        m_errors += m_levels[site] == Crobots::LogLevel::Error;
+    }
+    uint32_t m_errors = 0;
+
+private:
+    std::vector<Crobots::LogLevel> m_levels;
+};
+
+bool Fail(const char* message)
+{
+    std::cerr << message << std::endl;
+    return false;
+}
+
+bool Test(const std::string& directory)
+{
+    Crobots::ModuleRegistry& registry = Crobots::ModuleRegistry::Get();
+    registry.SetDirectory(directory);
+
+    Crobots::RobotFactory dummy = registry.Find("Dummy");
+    Crobots::RobotFactory again = registry.Find("Dummy");
+    if (!dummy || !again || dummy.module != again.module || dummy.create != again.create)
+    {
+        return Fail("Dummy was not opened once and shared");
+    }
+    Crobots::RobotFactory rook = registry.Find("Classics");
+    Crobots::RobotFactory bishop = registry.Find("Classics:Bishop");
+    if (!rook || !bishop || rook.module != bishop.module || rook.create == bishop.create ||
+        rook.create != registry.Find("Classics:Rook").create)
+    {
+        return Fail("the classes of Classics were not found");
+    }
+    if (registry.Find("Classics:Knight") || registry.Find("../Dummy") || registry.Find("/Dummy") ||
+        registry.Find("") || registry.Find("Nobody"))
+    {
+        return Fail("a robot that does not exist was found");
+    }
+
+    auto engine = std::make_shared<Crobots::Engine>();
+    engine->Init(Crobots::Arena(100, 100), false, true, false, 3);
+    std::vector<std::shared_ptr<Crobots::IRobot>> robots;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Crobots::RobotFactory& factory = i == 0 ? rook : bishop;
+        robots.emplace_back(factory.create(engine->GetProxy(i)), [module = factory.module](Crobots::IRobot* robot)
+        {
+            delete robot;
+        });
+    }
+    if (robots[0]->GetName() != "Rook" || robots[1]->GetName() != "Bishop")
+    {
+        return Fail("the factories made the wrong robots");
+    }
+    engine->Load(std::move(robots));
+    for (uint32_t tick = 0; tick < 100; tick++)
+    {
+        engine->Tick();
+    }
+
+    // The robots keep the module open after the factories are gone.
+    dummy = again = rook = bishop = {};
+    if (registry.IsLoaded("Dummy") || !registry.IsLoaded("Classics"))
+    {
+        return Fail("modules were not kept open exactly as long as they were used");
+    }
+    engine->Unload();
+    engine.reset();
+    if (registry.IsLoaded("Classics"))
+    {
+        return Fail("Classics stayed open after its robots were gone");
+    }
+
+    // The tests are built next to SDL, which is no robot module.
+    ErrorCounter errors;
+    Crobots::Internal::SetLogSink(&errors);
+    std::vector<std::string> found = registry.Preload(2);
+    Crobots::Internal::SetLogSink(nullptr);
+    for (const char* name : {"Classics:Rook", "Classics:Bishop", "Doofus", "Dummy"})
+    {
+        if (std::find(found.begin(), found.end(), name) == found.end())
+        {
+            std::cerr << name << " was not preloaded" << std::endl;
+            return false;
+        }
+    }
+    if (found.size() != 4 || errors.m_errors != 0)
+    {
+        return Fail("preloading logged errors or found robots in other libraries");
+    }
+    if (!registry.IsLoaded("Doofus") || !registry.IsLoaded("Classics"))
+    {
+        return Fail("preloaded modules were not kept open");
+    }
+    registry.Release();
+    return !registry.IsLoaded("Doofus") || Fail("preloaded modules stayed open after Release");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    // The robot modules are built next to the tests.
+    std::filesystem::path directory = std::filesystem::absolute(argv[0]).parent_path();
+    return Test(directory.string()) ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "src/TaskPool.hpp"
+#include "test/TestRobots.hpp"
+
+// Ticking robots on a pool must play out exactly like ticking them one after another.
+
+namespace
+{
+
+struct Run
+{
+    std::vector<float> states;
+    std::vector<bool> detected;
+};
+
+Run Play(Crobots::TaskPool* pool)
+{
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Crobots::Test::Brawler>(24, 60, 99);
+    engine->SetTaskPool(pool);
+    Run run;
+    for (uint32_t tick = 0; tick < 400 && !engine->IsGameOver(); tick++)
+    {
+        engine->Tick();
+        const Crobots::RobotStates& states = engine->GetStates();
+        for (uint32_t i = 0; i < states.GetCount(); i++)
+        {
+            run.states.insert(run.states.end(), {states.m_currentX[i], states.m_currentY[i],
+                              states.m_facing[i], states.m_speed[i], states.m_damage[i]});
+            run.detected.push_back(engine->GetRobots()[i]->IsDetected());
+        }
+    }
+    engine->Unload();
+    return run;
+}
+
+}
+
+int main()
+{
+    Run serial = Play(nullptr);
+    if (std::count(serial.detected.begin(), serial.detected.end(), true) == 0)
+    {
+        std::cerr << "no robot was ever scanned, nothing was tested" << std::endl;
+        return 1;
+    }
+    Crobots::TaskPool pool(4);
+    for (uint32_t attempt = 0; attempt < 3; attempt++)
+    {
+        Run parallel = Play(&pool);
+        if (parallel.states.size() != serial.states.size() ||
+            std::memcmp(parallel.states.data(), serial.states.data(), serial.states.size() * sizeof(float)) != 0 ||
+            parallel.detected != serial.detected)
+        {
+            std::cerr << "parallel run " << attempt << " differs from the serial run" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "src/Profiler.hpp"
+#include "test/TestRobots.hpp"
+
+// The profiler times every phase of every tick and every robot's Tick, and counts the
+// scans and contacts the robots made themselves.
+
+int main()
+{
+    constexpr uint32_t Count = 8;
+    constexpr uint32_t Ticks = 200;
+    // Without damage every robot ticks every tick.
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Crobots::Test::Sweeper>(Count, 40, 21, false);
+    Crobots::Profiler profiler;
+    engine->SetProfiler(&profiler);
+    for (uint32_t tick = 0; tick < Ticks; tick++)
+    {
+        engine->Tick();
+    }
+    for (uint32_t i = 0; i < static_cast<uint32_t>(Crobots::Phase::Count); i++)
+    {
+        if (profiler.GetPhase(static_cast<Crobots::Phase>(i)).GetCount() != Ticks)
+        {
+            std::cerr << "phase " << Crobots::GetPhaseName(static_cast<Crobots::Phase>(i)) << " was not timed every tick"
+                      << std::endl;
+            return 1;
+        }
+    }
+    const Crobots::CostHistogram& tick = profiler.GetPhase(Crobots::Phase::Tick);
+    if (tick.GetTotal() < profiler.GetPhase(Crobots::Phase::Robots).GetTotal() || tick.GetMax() == 0)
+    {
+        std::cerr << "the tick took less time than its robots" << std::endl;
+        return 1;
+    }
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        const Crobots::RobotProfile& robot = profiler.GetRobot(i);
+        const auto& sweeper = static_cast<const Crobots::Test::Sweeper&>(*engine->GetRobots()[i]);
+        if (robot.tick.GetCount() != Ticks || robot.scans != sweeper.m_scans || robot.contacts < sweeper.m_contacts ||
+            robot.scanTests < robot.contacts)
+        {
+            std::cerr << "robot " << i << " was not profiled right" << std::endl;
+            return 1;
+        }
+    }
+    // Nothing is recorded once the profiler is detached.
+    engine->SetProfiler(nullptr);
+    engine->Tick();
+    if (profiler.GetPhase(Crobots::Phase::Tick).GetCount() != Ticks || profiler.GetRobot(0).tick.GetCount() != Ticks)
+    {
+        std::cerr << "a detached profiler was still fed" << std::endl;
+        return 1;
+    }
+    double nsPerCycle = profiler.GetNanosecondsPerCycle();
+    if (!(nsPerCycle > 0 && nsPerCycle < 100))
+    {
+        std::cerr << "implausible cycle length " << nsPerCycle << " ns" << std::endl;
+        return 1;
+    }
+    engine->Unload();
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "src/Replay.hpp"
+#include "test/TestRobots.hpp"
+
+// Record a match, then check that every tick reads back as recorded, both when played
+// through in order and when seeking straight to it.
+
+namespace
+{
+
+// Drives in circles, sweeping the scanner and firing, so every field changes.
+class Circler : public Crobots::IRobot
+{
+public:
+    std::string_view GetName() const override { return "circler"; }
+    void Tick() override
+    {
+        m_turn = m_turn + 7;
+        Drive(m_turn / 10, 60);
+        Scan(m_turn, 20);
+        Cannon(m_turn, 50);
+    }
+
+private:
+    float m_turn = 0;
+};
+
+Crobots::ReplayFrame Expected(const Crobots::Engine& engine)
+{
+    Crobots::ReplayFrame frame;
+    frame.tick = engine.GetTick();
+    const Crobots::RobotStates& states = engine.GetStates();
+    for (uint32_t i = 0; i < engine.GetRobots().size(); i++)
+    {
+        const Crobots::IRobot& robot = *engine.GetRobots()[i];
+        float values[] = {states.m_currentX[i], states.m_currentY[i], states.m_facing[i], states.m_speed[i],
+                          states.m_damage[i], robot.GetScanDir(), robot.GetResolution()};
+        Crobots::ReplayRobot entry;
+        for (uint32_t field = 0; field < Crobots::ReplayFieldCount; field++)
+        {
+            entry.fields[field] = Crobots::ReplayQuantize(values[field], Crobots::ReplayScales[field]) / Crobots::ReplayScales[field];
+        }
+        frame.robots.push_back(entry);
+    }
+    const Crobots::ShotPool& shots = engine.GetShots();
+    for (uint32_t i = 0; i < shots.GetCount(); i++)
+    {
+        frame.shots.push_back({Crobots::ReplayQuantize(shots.m_currentX[i], Crobots::ReplayShotScale) / Crobots::ReplayShotScale,
+                               Crobots::ReplayQuantize(shots.m_currentY[i], Crobots::ReplayShotScale) / Crobots::ReplayShotScale});
+    }
+    return frame;
+}
+
+bool Same(const Crobots::ReplayFrame& a, const Crobots::ReplayFrame& b)
+{
+    if (a.tick != b.tick || a.robots.size() != b.robots.size() || a.shots.size() != b.shots.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.robots.size(); i++)
+    {
+        for (uint32_t field = 0; field < Crobots::ReplayFieldCount; field++)
+        {
+            if (a.robots[i].fields[field] != b.robots[i].fields[field])
+            {
+                return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < a.shots.size(); i++)
+    {
+        if (a.shots[i].x != b.shots[i].x || a.shots[i].y != b.shots[i].y)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main()
+{
+    const char* path = "test_replay.replay";
+    const uint32_t robotCount = 4;
+    const uint32_t ticks = 1000;
+
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Circler>(robotCount, 200, 7);
+
+    std::vector<Crobots::ReplayFrame> expected;
+    Crobots::ReplayRecorder recorder;
+    if (!recorder.Start(path, *engine, 64))
+    {
+        std::cerr << "cannot write " << path << std::endl;
+        return 1;
+    }
+    engine->SetRecorder(&recorder);
+    expected.push_back(Expected(*engine));
+    for (uint32_t i = 0; i < ticks && !engine->IsGameOver(); i++)
+    {
+        engine->Tick();
+        expected.push_back(Expected(*engine));
+    }
+    engine->SetRecorder(nullptr);
+    recorder.Finish();
+    engine->Unload();
+
+    Crobots::ReplayReader reader;
+    if (!reader.Open(path) || reader.GetNames().size() != robotCount || reader.GetSeed() != 7 ||
+        reader.GetLastTick() != expected.back().tick)
+    {
+        std::cerr << "bad replay header" << std::endl;
+        return 1;
+    }
+    uint32_t failures = 0;
+    Crobots::ReplayFrame frame;
+    if (!reader.Seek(0, frame) || !Same(frame, expected[0]))
+    {
+        failures++;
+    }
+    for (size_t i = 1; i < expected.size(); i++)
+    {
+        if (!reader.Next(frame) || !Same(frame, expected[i]))
+        {
+            std::cerr << "tick " << i << " differs when played in order" << std::endl;
+            failures++;
+        }
+    }
+    for (size_t i = expected.size(); i-- > 0;)
+    {
+        if (!reader.Seek(i, frame) || !Same(frame, expected[i]))
+        {
+            std::cerr << "tick " << i << " differs after seeking" << std::endl;
+            failures++;
+        }
+    }
+    reader.Close();
+    std::remove(path);
+    return failures == 0 ? 0 : 1;
+}
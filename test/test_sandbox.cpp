@@ -0,0 +1,230 @@
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/Sandbox.hpp"
+#include "src/SharedRing.hpp"
+#include "test/TestRobots.hpp"
+
+// A sandboxed match plays out exactly like one in process, also after a Reset, and a robot
+// that crashes, hangs or writes over its sandbox's rings is out of the match while the
+// others play on.
+
+namespace
+{
+
+class Crasher : public Crobots::IRobot
+{
+public:
+    std::string_view GetName() const override { return "crasher"; }
+    void Tick() override
+    {
+        if (++m_ticks == 20)
+        {
+            std::raise(SIGSEGV);
+        }
+    }
+
+private:
+    uint32_t m_ticks = 0;
+};
+
+class Hanger : public Crobots::IRobot
+{
+public:
+    std::string_view GetName() const override { return "hanger"; }
+    void Tick() override
+    {
+        if (++m_ticks == 30)
+        {
+            for (volatile bool spin = true; spin;)
+            {
+            }
+        }
+    }
+
+private:
+    uint32_t m_ticks = 0;
+};
+
+// Finds its sandbox's shared memory and publishes an intent of its own ahead of the
+// engine's, claiming a scan that found far more robots than there are.
+class Scribbler : public Crobots::IRobot
+{
+public:
+    std::string_view GetName() const override { return "scribbler"; }
+    void Tick() override
+    {
+        if (++m_ticks != 25)
+        {
+            return;
+        }
+        std::ifstream maps("/proc/self/maps");
+        for (std::string line; std::getline(maps, line);)
+        {
+            if (line.find("crobots_sandbox") == std::string::npos)
+            {
+                continue;
+            }
+            // With a few robots both rings have the smallest capacity, so the intents
+            // start right after a 4096 byte snapshot ring.
+            char* memory = reinterpret_cast<char*>(std::stoull(line, nullptr, 16));
+            size_t offset = (Crobots::SharedRing::GetSize(4096) + 63) & ~size_t(63);
+            Crobots::SharedRing ring = Crobots::SharedRing::Attach(memory + offset);
+            uint32_t size = Crobots::SandboxIntent::GetSize(5);
+            if (auto* intent = static_cast<Crobots::SandboxIntent*>(ring.Reserve(size)))
+            {
+                std::memset(intent, 0, size);
+                intent->hitCount = 0x7fffffff;
+                ring.Publish();
+            }
+            return;
+        }
+    }
+
+private:
+    uint32_t m_ticks = 0;
+};
+
+template<typename T>
+std::shared_ptr<Crobots::IRobot> Make(uint32_t id, std::shared_ptr<Crobots::Engine>& engine)
+{
+    return std::shared_ptr<Crobots::IRobot>(Crobots::IRobot::Create<T>(engine->GetProxy(id)));
+}
+
+std::vector<float> Play(bool sandboxed)
+{
+    auto engine = std::make_shared<Crobots::Engine>();
+    engine->Init(Crobots::Arena(60, 60), false, true, false, 5);
+    engine->SetSandbox({sandboxed, 1000000000});
+    engine->Load(Crobots::Test::MakeRobots<Crobots::Test::Brawler>(*engine, 6));
+    std::vector<float> states;
+    // The sandboxes serve the second match too.
+    for (uint64_t seed : {5, 6})
+    {
+        if (seed != 5)
+        {
+            engine->Reset(seed);
+        }
+        for (uint32_t tick = 0; tick < 300 && !engine->IsGameOver(); tick++)
+        {
+            engine->Tick();
+            const Crobots::RobotStates& s = engine->GetStates();
+            for (uint32_t i = 0; i < s.GetCount(); i++)
+            {
+                states.insert(states.end(), {s.m_currentX[i], s.m_currentY[i], s.m_facing[i], s.m_damage[i],
+                              engine->GetRobots()[i]->GetScanDir(), engine->GetRobots()[i]->IsDetected() ? 1.0f : 0.0f});
+            }
+        }
+    }
+    engine->Unload();
+    return states;
+}
+
+bool TestRing()
+{
+    // Records of every size up to 200 bytes, through a ring small enough to wrap often.
+    uint32_t capacity = 1024;
+    std::vector<char> memory(Crobots::SharedRing::GetSize(capacity) + 64);
+    void* aligned = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(memory.data()) + 63) & ~uintptr_t(63));
+    Crobots::SharedRing ring = Crobots::SharedRing::Create(aligned, capacity);
+    constexpr uint32_t Count = 20000;
+    std::thread producer([&ring]
+    {
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            uint32_t size = 4 + i % 200;
+            void* record;
+            while (!(record = ring.Reserve(size)))
+            {
+                std::this_thread::yield();
+            }
+            std::memset(record, i & 0xff, size);
+            std::memcpy(record, &i, sizeof(i));
+            ring.Publish();
+        }
+    });
+    bool ok = true;
+    for (uint32_t i = 0; i < Count && ok; i++)
+    {
+        uint32_t size = 0;
+        const char* record = static_cast<const char*>(ring.Wait(1000000000, size));
+        uint32_t value = 0;
+        ok = record != nullptr && size == 4 + i % 200;
+        if (ok)
+        {
+            std::memcpy(&value, record, sizeof(value));
+            ok = value == i && static_cast<uint8_t>(record[size - 1]) == (size > 4 ? (i & 0xff) : (i >> 24));
+            ring.Release();
+        }
+    }
+    producer.join();
+    return ok;
+}
+
+}
+
+int main()
+{
+    // Before TestRing starts a thread.
+    if (!Crobots::Engine::StartSandboxHelper())
+    {
+        std::cerr << "cannot start the sandbox helper" << std::endl;
+        return 1;
+    }
+    if (!TestRing())
+    {
+        std::cerr << "records came out of the ring wrong" << std::endl;
+        return 1;
+    }
+
+    std::vector<float> local = Play(false);
+    std::vector<float> sandboxed = Play(true);
+    if (sandboxed.size() != local.size() ||
+        std::memcmp(sandboxed.data(), local.data(), local.size() * sizeof(float)) != 0)
+    {
+        std::cerr << "the sandboxed match differs from the one in process" << std::endl;
+        return 1;
+    }
+
+    auto engine = std::make_shared<Crobots::Engine>();
+    engine->Init(Crobots::Arena(60, 60), false, true, false, 5);
+    engine->SetSandbox({true, 50000000});
+    std::vector<std::shared_ptr<Crobots::IRobot>> robots{Make<Crasher>(0, engine), Make<Hanger>(1, engine),
+                                                         Make<Crobots::Test::Brawler>(2, engine),
+                                                         Make<Scribbler>(3, engine), Make<Crobots::Test::Idle>(4, engine)};
+    engine->Load(std::move(robots));
+    for (uint32_t tick = 0; tick < 60; tick++)
+    {
+        engine->Tick();
+    }
+    const auto& loaded = engine->GetRobots();
+    if (loaded[0]->GetDeathData().Type != Crobots::DamageType::Crashed ||
+        loaded[1]->GetDeathData().Type != Crobots::DamageType::Crashed ||
+        loaded[2]->GetDeathData().Type == Crobots::DamageType::Crashed ||
+        loaded[3]->GetDeathData().Type != Crobots::DamageType::Crashed ||
+        loaded[4]->GetDeathData().Type == Crobots::DamageType::Crashed || engine->GetTick() != 60)
+    {
+        std::cerr << "the crashed, hung and scribbling robots were not taken out of the match" << std::endl;
+        return 1;
+    }
+    // Their sandboxes are started again for the next match.
+    engine->Reset(5);
+    for (uint32_t tick = 0; tick < 10; tick++)
+    {
+        engine->Tick();
+    }
+    if (loaded[0]->GetDeathData().Type == Crobots::DamageType::Crashed ||
+        loaded[1]->GetDeathData().Type == Crobots::DamageType::Crashed ||
+        loaded[3]->GetDeathData().Type == Crobots::DamageType::Crashed)
+    {
+        std::cerr << "the crashed, hung and scribbling robots were not sandboxed again after Reset" << std::endl;
+        return 1;
+    }
+    engine->Unload();
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "src/ShotPool.hpp"
+
+// Fly a batch of shots (enough to fill whole SIMD blocks and leave a tail) and check
+// them against a plain step-by-step integration, then check that ids survive swap-removes.
+
+int main()
+{
+    Crobots::ShotPool pool;
+    std::vector<float> x, y;
+    const uint32_t count = 21;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float range = 3.0f + i * 1.7f;
+        uint32_t id = pool.Add(50.0f, 40.0f, i * 17.0f, 0.25f + i * 0.125f, range);
+        if (id != i || std::fabs(std::hypot(pool.m_targetX[i] - 50.0f, pool.m_targetY[i] - 40.0f) - range) > 1e-3f)
+        {
+            std::cerr << "shot " << i << " added wrong" << std::endl;
+            return 1;
+        }
+        x.push_back(50.0f);
+        y.push_back(40.0f);
+    }
+    for (uint32_t tick = 0; tick < 50; tick++)
+    {
+        pool.Integrate();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            x[i] += pool.m_velocityX[i];
+            y[i] += pool.m_velocityY[i];
+            if (pool.m_currentX[i] != x[i] || pool.m_currentY[i] != y[i])
+            {
+                std::cerr << "shot " << i << " diverged at tick " << tick << std::endl;
+                return 1;
+            }
+        }
+    }
+    // 3 / 0.25 is exactly 12 ticks; anything that cannot fly goes off on the next one.
+    if (pool.GetFlightTicks(0) != 12 || pool.GetFlightTicks(pool.GetIndex(pool.Add(0, 0, 0, 0, 10))) != 1)
+    {
+        std::cerr << "wrong flight time" << std::endl;
+        return 1;
+    }
+    pool.Remove(pool.GetIndex(3));
+    pool.Remove(pool.GetIndex(0));
+    for (uint32_t id = 1; id < count; id++)
+    {
+        if (id != 3 && pool.m_id[pool.GetIndex(id)] != id)
+        {
+            std::cerr << "id " << id << " lost after removes" << std::endl;
+            return 1;
+        }
+    }
+    // Freed ids are handed out again.
+    if (pool.Add(0, 0, 0, 1, 1) != 0 || pool.GetCount() != count)
+    {
+        std::cerr << "ids are not reused" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "test/TestRobots.hpp"
+
+// Scans through the spatial grid must report exactly what a scan of every robot reports.
+
+namespace
+{
+
+// Run one scan and describe everything it changed.
+std::string Scan(Crobots::Engine& engine, uint32_t id, float degree, float resolution, bool brute)
+{
+    engine.SetBruteForceScan(brute);
+    for (const std::shared_ptr<Crobots::IRobot>& robot : engine.GetRobots())
+    {
+        robot->ClearContacts();
+    }
+    std::string out = std::to_string(engine.ScanResult(id, degree, resolution)) + "\n";
+    for (const auto& contact : engine.GetRobots()[id]->GetContacts())
+    {
+        out += contact.ToString();
+    }
+    return out;
+}
+
+}
+
+int main()
+{
+    const uint32_t sizes[][3] = {
+        // arena x, arena y, robots
+        { 100, 100, 2 },
+        { 100, 100, 40 },
+        { 1000, 1000, 400 },
+        { 1000, 200, 100 },
+        { 20, 20, 200 },
+    };
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> degree(-400.0f, 760.0f);
+    std::uniform_real_distribution<float> resolution(0.0f, 60.0f);
+    uint32_t failures = 0;
+    for (const auto& size : sizes)
+    {
+        auto engine = std::make_shared<Crobots::Engine>();
+        engine->Init(Crobots::Arena(size[0], size[1]), false, true, false, gen());
+        engine->Load(Crobots::Test::MakeRobots<Crobots::Test::Idle>(*engine, size[2]));
+        for (uint32_t i = 0; i < 300; i++)
+        {
+            uint32_t id = gen() % size[2];
+            float d = degree(gen);
+            // Include the integer directions and wide scans, which sit on the edges of the sector.
+            if (i % 3 == 0)
+            {
+                d = static_cast<int>(d);
+            }
+            float r = i % 50 == 0 ? 400.0f : resolution(gen);
+            std::string grid = Scan(*engine, id, d, r, false);
+            std::string brute = Scan(*engine, id, d, r, true);
+            if (grid != brute)
+            {
+                std::cerr << "mismatch: robot " << id << " degree " << d << " resolution " << r
+                          << "\ngrid:\n" << grid << "brute force:\n" << brute;
+                failures++;
+            }
+        }
+        engine->Unload();
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "src/SweepAndPrune.hpp"
+
+// Sweep and prune must find exactly the overlapping pairs a test of every pair finds, both
+// from scratch and as robots drift around between calls.
+
+int main()
+{
+    const float radius = 1.0f;
+    std::mt19937 random(11);
+    for (uint32_t count : {0u, 1u, 2u, 50u, 600u})
+    {
+        std::uniform_real_distribution<float> place(1.0f, 60.0f);
+        std::uniform_real_distribution<float> drift(-0.6f, 0.6f);
+        std::vector<float> x(count), y(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            x[i] = place(random);
+            y[i] = place(random);
+        }
+        Crobots::SweepAndPrune sweep;
+        sweep.Resize(count);
+        std::vector<std::pair<uint32_t, uint32_t>> pairs, expected;
+        for (uint32_t tick = 0; tick < 40; tick++)
+        {
+            sweep.FindPairs(x.data(), y.data(), radius, pairs);
+            expected.clear();
+            for (uint32_t a = 0; a < count; a++)
+            {
+                for (uint32_t b = a + 1; b < count; b++)
+                {
+                    float dx = x[b] - x[a];
+                    float dy = y[b] - y[a];
+                    if (dx * dx + dy * dy < 4 * radius * radius)
+                    {
+                        expected.emplace_back(a, b);
+                    }
+                }
+            }
+            if (pairs != expected)
+            {
+                std::cerr << count << " robots, tick " << tick << ": found " << pairs.size()
+                          << " pairs, expected " << expected.size() << std::endl;
+                return 1;
+            }
+            for (uint32_t i = 0; i < count; i++)
+            {
+                x[i] += drift(random);
+                y[i] += drift(random);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <vector>
+
+#include <Crobots++/Random.hpp>
+#include "src/TimingWheel.hpp"
+
+// Schedule events at every distance the wheel handles, from this tick to past its last
+// level, and check that each one comes out on exactly the tick it was scheduled for.
+
+int main()
+{
+    Crobots::TimingWheel wheel;
+    Crobots::Random random;
+    random.Seed(7, 0);
+    const uint64_t start = 1000;
+    const uint64_t horizon = (uint64_t{1} << 24) + 5000;
+    wheel.Reset(start);
+
+    std::vector<uint64_t> ticks;
+    auto schedule = [&](uint64_t tick)
+    {
+        wheel.Schedule(tick, ticks.size());
+        ticks.push_back(tick);
+    };
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        // Spread the delays over every level: up to 64, 4096, 262144 and beyond.
+        uint32_t level = random.Bounded(4);
+        uint32_t limit = level == 4 ? horizon - start : 1u << (6 * level);
+        schedule(start + random.Bounded(limit) - 1);
+    }
+    schedule(start - 10);
+    schedule((uint64_t{1} << 24) + 17);
+
+    std::vector<uint32_t> due;
+    uint32_t fired = 0;
+    while (wheel.GetTick() < horizon)
+    {
+        uint64_t tick = wheel.GetTick();
+        due.clear();
+        wheel.Collect(due);
+        for (uint32_t payload : due)
+        {
+            uint64_t expected = ticks[payload] < start ? start : ticks[payload];
+            if (expected != tick)
+            {
+                std::cerr << "event " << payload << " for tick " << expected << " fired on " << tick << std::endl;
+                return 1;
+            }
+            fired++;
+        }
+        // Events scheduled while running land just as well.
+        if (tick % 9973 == 0 && tick + 5000 < horizon)
+        {
+            schedule(tick + 1 + tick % 4999);
+        }
+    }
+    if (fired != ticks.size() || wheel.GetPendingCount() != 0)
+    {
+        std::cerr << "fired " << fired << " of " << ticks.size() << " events" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "src/ModuleRegistry.hpp"
+#include "src/Trace.hpp"
+#include "test/TestRobots.hpp"
+
+// The trace recorder writes engine phases, robot ticks and events from every thread as
+// Chrome trace JSON, and records nothing while stopped. Robots loaded from modules, which
+// carry their own copy of the engine code, show up in the trace too.
+
+namespace
+{
+
+uint32_t CountOf(const std::string& text, const std::string& needle)
+{
+    uint32_t count = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1))
+    {
+        count++;
+    }
+    return count;
+}
+
+// What the recorder has, as written out; empty if writing failed.
+std::string ReadTrace(Crobots::TraceRecorder& recorder)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "crobots_test_trace.json").string();
+    if (!recorder.Write(path))
+    {
+        return {};
+    }
+    std::stringstream stream;
+    stream << std::ifstream(path).rdbuf();
+    std::filesystem::remove(path);
+    return stream.str();
+}
+
+bool TestModuleRobots(const std::string& directory)
+{
+    Crobots::ModuleRegistry& registry = Crobots::ModuleRegistry::Get();
+    registry.SetDirectory(directory);
+    Crobots::RobotFactory rook = registry.Find("Classics:Rook");
+    if (!rook)
+    {
+        std::cerr << "cannot load Classics:Rook" << std::endl;
+        return false;
+    }
+    auto engine = std::make_shared<Crobots::Engine>();
+    engine->Init(Crobots::Arena(100, 100), false, false, false, 5);
+    std::vector<std::shared_ptr<Crobots::IRobot>> robots;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        robots.emplace_back(rook.create(engine->GetProxy(i)), [module = rook.module](Crobots::IRobot* robot)
+        {
+            delete robot;
+        });
+    }
+    engine->Load(std::move(robots));
+    Crobots::TraceRecorder& recorder = Crobots::TraceRecorder::Get();
+    recorder.Start();
+    for (uint32_t tick = 0; tick < 60; tick++)
+    {
+        engine->Tick();
+    }
+    recorder.Stop();
+    engine->Unload();
+    std::string text = ReadTrace(recorder);
+    if (CountOf(text, "\"name\":\"robot_tick\"") != 120 || CountOf(text, "\"name\":\"scan\"") == 0)
+    {
+        std::cerr << "expected the ticks and scans of the robots from a module" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    constexpr uint32_t Ticks = 120;
+    Crobots::TraceRecorder& recorder = Crobots::TraceRecorder::Get();
+    Crobots::TraceRecorder::SetThreadName("main");
+    // Without damage every robot ticks every tick.
+    std::shared_ptr<Crobots::Engine> engine = Crobots::Test::MakeEngine<Crobots::Test::Sweeper>(4, 40, 5, false);
+
+    // Nothing is kept while stopped.
+    engine->Tick();
+    if (recorder.GetEventCount() != 0)
+    {
+        std::cerr << "recorded while stopped" << std::endl;
+        return 1;
+    }
+
+    recorder.Start();
+    for (uint32_t tick = 0; tick < Ticks; tick++)
+    {
+        engine->Tick();
+    }
+    std::thread other([]
+    {
+        Crobots::TraceRecorder::SetThreadName("other \"thread\"");
+        Crobots::TraceScope scope("work", "test", 7);
+    });
+    other.join();
+    recorder.Stop();
+    uint64_t events = recorder.GetEventCount();
+    engine->Tick();
+    if (recorder.GetEventCount() != events)
+    {
+        std::cerr << "recorded after stop" << std::endl;
+        return 1;
+    }
+
+    std::string text = ReadTrace(recorder);
+    if (text.empty())
+    {
+        std::cerr << "write failed" << std::endl;
+        return 1;
+    }
+
+    if (CountOf(text, "\"name\":\"tick\"") != Ticks || CountOf(text, "\"name\":\"move_shots\"") != Ticks)
+    {
+        std::cerr << "expected one span per phase per tick" << std::endl;
+        return 1;
+    }
+    if (CountOf(text, "\"name\":\"robot_tick\"") != Ticks * 4 || CountOf(text, "\"args\":{\"id\":3}") < Ticks)
+    {
+        std::cerr << "expected a span per robot tick" << std::endl;
+        return 1;
+    }
+    if (CountOf(text, "\"name\":\"scan\"") == 0 || CountOf(text, "\"name\":\"shot\"") == 0)
+    {
+        std::cerr << "expected scan and shot events" << std::endl;
+        return 1;
+    }
+    if (CountOf(text, "\"ph\":\"M\"") != 2 || CountOf(text, "\"name\":\"main\"") != 1 ||
+        CountOf(text, "\"name\":\"other \\\"thread\\\"\"") != 1 || CountOf(text, "\"name\":\"work\"") != 1)
+    {
+        std::cerr << "expected a named timeline per thread" << std::endl;
+        return 1;
+    }
+    if (CountOf(text, "{") != CountOf(text, "}") || CountOf(text, "[") != CountOf(text, "]") ||
+        !text.starts_with("{") || text.find("\n]}") == std::string::npos)
+    {
+        std::cerr << "malformed trace" << std::endl;
+        return 1;
+    }
+    // The robot modules are built next to the tests.
+    return TestModuleRobots(std::filesystem::absolute(argv[0]).parent_path().string()) ? 0 : 1;
+}